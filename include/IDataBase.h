@@ -17,14 +17,64 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <system_error>
+#include <vector>
 
 #include "IWriteBatch.h"
 #include "IReadBatch.h"
 
 namespace CryptoNote {
 
+/* Latencies in microseconds */
+struct DataBaseLatency {
+  uint64_t count = 0;
+  double median = 0;
+  double percentile95 = 0;
+  double percentile99 = 0;
+  double max = 0;
+};
+
+struct DataBaseFamilyStatistics {
+  std::string name;
+
+  /* Keys passed to read() and write() since the database was opened */
+  uint64_t keysRead = 0;
+  uint64_t keysFound = 0;
+  uint64_t bytesRead = 0;
+  uint64_t keysWritten = 0;
+  uint64_t keysRemoved = 0;
+  uint64_t bytesWritten = 0;
+
+  uint64_t memtableBytes = 0;
+  uint64_t level0Files = 0;
+  uint64_t tableBytes = 0;
+  uint64_t estimatedKeys = 0;
+  /* Families sharing a block cache each report all of it */
+  uint64_t blockCacheBytes = 0;
+};
+
+struct DataBaseStatistics {
+  uint64_t readBatches = 0;
+  uint64_t writeBatches = 0;
+
+  uint64_t blockCacheHits = 0;
+  uint64_t blockCacheMisses = 0;
+
+  /* Time writes were held back waiting for flushes and compactions */
+  uint64_t stallMicros = 0;
+  bool writesStopped = false;
+  uint64_t runningCompactions = 0;
+  uint64_t compactionBytesRead = 0;
+  uint64_t compactionBytesWritten = 0;
+
+  DataBaseLatency readLatency;
+  DataBaseLatency writeLatency;
+
+  std::vector<DataBaseFamilyStatistics> families;
+};
+
 class IDataBase {
 public:
   virtual ~IDataBase() {
@@ -33,5 +83,23 @@ public:
   virtual std::error_code write(IWriteBatch& batch) = 0;
 
   virtual std::error_code read(IReadBatch& batch) = 0;
+
+  /* Databases which hold back writes to commit them together commit them
+     now. Others have nothing to do. */
+  virtual std::error_code flush() {
+    return std::error_code();
+  }
+
+  /* Writes a consistent copy of the database to directory, which mustn't
+     exist yet. Only databases kept on disk can do so, the rest return
+     std::errc::operation_not_supported. */
+  virtual std::error_code createCheckpoint(const std::string&) {
+    return std::make_error_code(std::errc::operation_not_supported);
+  }
+
+  /* Databases which don't keep statistics return them all zero */
+  virtual DataBaseStatistics getStatistics() const {
+    return DataBaseStatistics();
+  }
 };
 }
@@ -5,15 +5,48 @@
 
 #include "DataBaseConfig.h"
 
+#include <algorithm>
+
 #include <Common/Util.h>
 #include "Common/StringTools.h"
 #include "crypto/crypto.h"
 #include <config/CryptoNoteConfig.h>
+#include <CryptoNoteCore/DBUtils.h>
 
 using namespace CryptoNote;
 
 namespace {
+  const uint64_t KILOBYTE = 1024;
   const uint64_t MEGABYTE = 1024 * 1024;
+
+  /* Keys are the one byte prefix followed by the key, see DB::serializeKey() */
+  const size_t AMOUNT_PREFIX_LENGTH = 1 + sizeof(uint64_t);
+
+  /* Small blocks and bloom filters for the randomly accessed families, big
+     blocks and no filters for the ones read in height order, where the key
+     is almost always present. Fields are name, key prefix, block size, bloom
+     bits per key, prefix length, compression, read cache share. */
+  std::vector<ColumnFamilyConfig> getDefaultColumnFamilies() {
+    return {
+      {"spent_key_images_by_block", DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX, 16 * KILOBYTE, 0, 0, true, 0},
+      {"transaction_hashes_by_block", DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX, 16 * KILOBYTE, 0, 0, true, 0},
+      {"transaction_infos_by_block", DB::BLOCK_INDEX_TO_TRANSACTION_INFO_PREFIX, 16 * KILOBYTE, 0, 0, true, 0},
+      {"raw_blocks", DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, 64 * KILOBYTE, 0, 0, true, 15},
+      {"block_indexes_by_hash", DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX, 4 * KILOBYTE, 10, 0, false, 5},
+      {"block_infos", DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, 16 * KILOBYTE, 0, 0, true, 5},
+      {"block_indexes_by_key_image", DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX, 4 * KILOBYTE, 10, 0, false, 15},
+      {"block_hashes", DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX, 16 * KILOBYTE, 0, 0, true, 0},
+      {"transaction_infos", DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX, 4 * KILOBYTE, 10, 0, true, 15},
+      {"key_output_global_indexes", DB::KEY_OUTPUT_AMOUNT_PREFIX, 4 * KILOBYTE, 10, AMOUNT_PREFIX_LENGTH, true, 10},
+      {"closest_timestamp_block_indexes", DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, 4 * KILOBYTE, 10, 0, false, 0},
+      {"transaction_hashes_by_payment_id", DB::PAYMENT_ID_TO_TX_HASH_PREFIX, 4 * KILOBYTE, 10, 0, true, 0},
+      {"block_hashes_by_timestamp", DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX, 4 * KILOBYTE, 10, 0, true, 0},
+      {"key_output_amounts", DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX, 4 * KILOBYTE, 0, 0, false, 0},
+      {"key_outputs", DB::KEY_OUTPUT_KEY_PREFIX, 4 * KILOBYTE, 10, AMOUNT_PREFIX_LENGTH, true, 15},
+      {"wallet_block_infos", DB::BLOCK_INDEX_TO_WALLET_BLOCK_INFO_PREFIX, 64 * KILOBYTE, 0, 0, true, 10},
+      {"global_indexes_by_block", DB::BLOCK_INDEX_TO_GLOBAL_INDEXES_PREFIX, 64 * KILOBYTE, 0, 0, true, 0},
+    };
+  }
 }
 
 DataBaseConfig::DataBaseConfig() :
@@ -24,7 +57,8 @@ DataBaseConfig::DataBaseConfig() :
   readCacheSize(DATABASE_READ_BUFFER_MB_DEFAULT_SIZE * MEGABYTE),
   testnet(false),
   configFolderDefaulted(false),
-  compressionEnabled(false) {
+  compressionEnabled(false),
+  columnFamilies(getDefaultColumnFamilies()) {
 }
 
 bool DataBaseConfig::init(
@@ -78,4 +112,100 @@ bool DataBaseConfig::getTestnet() const {
 
 bool DataBaseConfig::getCompressionEnabled() const {
   return compressionEnabled;
-}
\ No newline at end of file
+}
+
+const std::vector<ColumnFamilyConfig>& DataBaseConfig::getColumnFamilies() const {
+  return columnFamilies;
+}
+
+bool DataBaseConfig::setColumnFamilyConfig(const ColumnFamilyConfig& config) {
+  for (auto& family : columnFamilies) {
+    if (family.name == config.name) {
+      family = config;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool DataBaseConfig::setColumnFamilyOptions(const std::string& options) {
+  const size_t nameEnd = options.find(':');
+  if (nameEnd == std::string::npos) {
+    return false;
+  }
+
+  const std::string name = options.substr(0, nameEnd);
+
+  auto family = std::find_if(columnFamilies.begin(), columnFamilies.end(), [&name](const auto& candidate) {
+    return candidate.name == name;
+  });
+
+  if (family == columnFamilies.end()) {
+    return false;
+  }
+
+  ColumnFamilyConfig config = *family;
+
+  size_t start = nameEnd + 1;
+
+  while (start <= options.size()) {
+    size_t end = options.find(',', start);
+    if (end == std::string::npos) {
+      end = options.size();
+    }
+
+    const std::string setting = options.substr(start, end - start);
+    const size_t separator = setting.find('=');
+
+    if (separator == std::string::npos) {
+      return false;
+    }
+
+    const std::string key = setting.substr(0, separator);
+    const std::string valueString = setting.substr(separator + 1);
+
+    uint64_t value;
+
+    try {
+      size_t parsed;
+      value = std::stoull(valueString, &parsed);
+
+      if (parsed != valueString.size()) {
+        return false;
+      }
+    } catch (const std::exception&) {
+      return false;
+    }
+
+    if (key == "block-size" && value != 0) {
+      config.blockSize = value;
+    } else if (key == "bloom-bits" && value <= 64) {
+      config.bloomFilterBitsPerKey = static_cast<int>(value);
+    } else if (key == "prefix-length" && value <= 64) {
+      config.prefixLength = static_cast<size_t>(value);
+    } else if (key == "compression" && value <= 1) {
+      config.compressionEnabled = value == 1;
+    } else if (key == "cache-share" && value <= 100) {
+      config.readCacheShare = static_cast<uint32_t>(value);
+    } else {
+      return false;
+    }
+
+    start = end + 1;
+  }
+
+  uint64_t reservedCacheShare = config.readCacheShare;
+  for (const auto& other : columnFamilies) {
+    if (other.name != name) {
+      reservedCacheShare += other.readCacheShare;
+    }
+  }
+
+  if (reservedCacheShare > 100) {
+    return false;
+  }
+
+  *family = config;
+  return true;
+}
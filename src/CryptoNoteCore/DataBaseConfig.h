@@ -11,6 +11,20 @@
 
 namespace CryptoNote {
 
+/* Tuning of one column family of the blockchain database. Every DBUtils key
+   prefix gets a family of its own, as their access patterns differ - key
+   images are random point lookups, raw blocks are appended and read in
+   order, outputs are looked up by amount and index. */
+struct ColumnFamilyConfig {
+  std::string name;
+  std::string keyPrefix; //Keys starting with this DBUtils prefix live in this family
+  uint64_t blockSize; //Bytes
+  int bloomFilterBitsPerKey; //0 disables the bloom filter
+  size_t prefixLength; //Leading key bytes used for prefix seeks and filters, 0 for none
+  bool compressionEnabled; //Only applies when DB compression is enabled
+  uint32_t readCacheShare; //Percent of the read cache reserved for this family, 0 to share the remainder
+};
+
 class DataBaseConfig {
 public:
   DataBaseConfig();
@@ -27,6 +41,15 @@ public:
   bool getTestnet() const;
   bool getCompressionEnabled() const;
 
+  const std::vector<ColumnFamilyConfig>& getColumnFamilies() const;
+  bool setColumnFamilyConfig(const ColumnFamilyConfig& config); //Returns false if there is no family with this name
+  /* Changes the settings of one family from a string of the form
+     <name>:<setting>=<value>,... where each setting is one of block-size,
+     bloom-bits, prefix-length, compression or cache-share. Returns false,
+     changing nothing, if the string is invalid or the cache shares of all
+     the families would add up to more than 100. */
+  bool setColumnFamilyOptions(const std::string& options);
+
 private:
   bool configFolderDefaulted;
   std::string dataDir;
@@ -36,5 +59,6 @@ private:
   uint64_t readCacheSize;
   bool testnet;
   bool compressionEnabled;
+  std::vector<ColumnFamilyConfig> columnFamilies;
 };
 } //namespace CryptoNote
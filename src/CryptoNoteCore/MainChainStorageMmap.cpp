@@ -0,0 +1,336 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "MainChainStorageMmap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <Common/CryptoNoteTools.h>
+#include <Common/FileSystemShim.h>
+
+#include "RawBlockStorageFormat.h"
+
+namespace CryptoNote
+{
+    namespace
+    {
+        /* Segments are created at their full size, which is sparse on most
+           filesystems until written to. A block never spans two segments. */
+        const uint64_t SEGMENT_SIZE = 256 * 1024 * 1024;
+
+        /* Each block is prefixed with its size */
+        const uint64_t BLOCK_HEADER_SIZE = sizeof(uint32_t);
+
+        /* The index grows by this many entries at a time, as growing it
+           copies the whole file */
+        const uint64_t INDEX_GROWTH = 1024 * 1024;
+
+        /* The segments and index are synced to disk after this many blocks
+           are pushed, and on shutdown */
+        const uint32_t FLUSH_INTERVAL = 1000;
+
+        std::string getSegmentFilename(const std::string &directory, const uint64_t segment)
+        {
+            std::stringstream filename;
+            filename << "blocks." << std::setw(6) << std::setfill('0') << segment;
+
+            return (fs::path(directory) / filename.str()).string();
+        }
+    }
+
+    MainChainStorageMmap::MainChainStorageMmap(const std::string &directory, const bool compressBlocks) :
+        m_directory(directory),
+        m_compressBlocks(compressBlocks)
+    {
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+
+        if (ec)
+        {
+            throw std::runtime_error("Failed to create main chain storage directory " + directory + ": " + ec.message());
+        }
+
+        m_index.open((fs::path(directory) / "index").string(), Common::FileMappedVectorOpenMode::OPEN_OR_CREATE);
+
+        /* Syncing every push is what we're trying to avoid, flush() does it
+           in bulk instead */
+        m_index.setAutoFlush(false);
+    }
+
+    MainChainStorageMmap::~MainChainStorageMmap()
+    {
+        std::scoped_lock lock(m_mutex);
+
+        /* The segments and index are also synced as they are unmapped, so
+           there's nothing more to be done if this fails */
+        try
+        {
+            flush();
+        }
+        catch (const std::exception &)
+        {
+        }
+    }
+
+    void MainChainStorageMmap::pushBlock(const RawBlock &rawBlock)
+    {
+        const std::string rawBlockData = serializeRawBlock(rawBlock, m_compressBlocks);
+
+        const uint64_t recordSize = BLOCK_HEADER_SIZE + rawBlockData.size();
+
+        if (recordSize > SEGMENT_SIZE)
+        {
+            throw std::runtime_error("Block of " + std::to_string(rawBlockData.size()) + " bytes is too large for main chain storage");
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        uint64_t position = getEndPosition();
+
+        /* Start a new segment if the block doesn't fit in this one */
+        if (position % SEGMENT_SIZE + recordSize > SEGMENT_SIZE)
+        {
+            position = (position / SEGMENT_SIZE + 1) * SEGMENT_SIZE;
+        }
+
+        uint8_t *data = getSegment(position / SEGMENT_SIZE).data() + position % SEGMENT_SIZE;
+
+        const uint32_t size = static_cast<uint32_t>(rawBlockData.size());
+
+        /* The block is written before it's added to the index, so the index
+           never points at a block that isn't there */
+        std::memcpy(data, &size, sizeof(size));
+        std::memcpy(data + BLOCK_HEADER_SIZE, rawBlockData.data(), rawBlockData.size());
+
+        if (m_index.capacity() == m_index.size())
+        {
+            m_index.reserve(m_index.capacity() + INDEX_GROWTH);
+        }
+
+        m_index.push_back(position);
+
+        if (++m_unflushedBlocks >= FLUSH_INTERVAL)
+        {
+            flush();
+        }
+    }
+
+    void MainChainStorageMmap::popBlock()
+    {
+        std::scoped_lock lock(m_mutex);
+
+        /* The block's data is left in place, and overwritten by the next
+           block pushed */
+        if (!m_index.empty())
+        {
+            m_index.pop_back();
+        }
+    }
+
+    void MainChainStorageMmap::rewindTo(const uint32_t index) const
+    {
+        std::scoped_lock lock(m_mutex);
+
+        while (m_index.size() > index)
+        {
+            m_index.pop_back();
+        }
+
+        m_index.flush();
+    }
+
+    RawBlock MainChainStorageMmap::getBlockByIndex(uint32_t index) const
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (index >= m_index.size())
+        {
+            throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(m_index.size()));
+        }
+
+        uint32_t size;
+        const uint8_t *data = getBlockData(index, size);
+
+        return deserializeRawBlock(reinterpret_cast<const char *>(data), size);
+    }
+
+    std::vector<RawBlock> MainChainStorageMmap::getBlocksByIndexRange(
+        const uint32_t startIndex,
+        const uint32_t endIndex) const
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (endIndex > m_index.size())
+        {
+            throw std::out_of_range("Block index " + std::to_string(endIndex - 1) + " is out of range. Blocks count: " + std::to_string(m_index.size()));
+        }
+
+        std::vector<RawBlock> rawBlocks;
+
+        if (startIndex >= endIndex)
+        {
+            return rawBlocks;
+        }
+
+        /* Blocks in a range are stored one after another, so ask for the
+           whole range to be read ahead, rather than faulting in each page
+           as we get to it. It may span a segment boundary. */
+        uint32_t lastSize;
+        getBlockData(endIndex - 1, lastSize);
+
+        const uint64_t startPosition = m_index[startIndex];
+        const uint64_t endPosition = m_index[endIndex - 1] + BLOCK_HEADER_SIZE + lastSize;
+
+        for (uint64_t segment = startPosition / SEGMENT_SIZE; segment <= (endPosition - 1) / SEGMENT_SIZE; segment++)
+        {
+            const uint64_t from = std::max(startPosition, segment * SEGMENT_SIZE) - segment * SEGMENT_SIZE;
+            const uint64_t to = std::min(endPosition, (segment + 1) * SEGMENT_SIZE) - segment * SEGMENT_SIZE;
+
+            const System::MemoryMappedFile &file = getSegment(segment);
+            file.prefetch(file.data() + from, to - from);
+        }
+
+        rawBlocks.reserve(endIndex - startIndex);
+
+        for (uint32_t index = startIndex; index < endIndex; index++)
+        {
+            uint32_t size;
+            const uint8_t *data = getBlockData(index, size);
+
+            rawBlocks.push_back(deserializeRawBlock(reinterpret_cast<const char *>(data), size));
+        }
+
+        return rawBlocks;
+    }
+
+    uint32_t MainChainStorageMmap::getBlockCount() const
+    {
+        std::scoped_lock lock(m_mutex);
+
+        return static_cast<uint32_t>(m_index.size());
+    }
+
+    void MainChainStorageMmap::clear()
+    {
+        std::scoped_lock lock(m_mutex);
+
+        m_index.clear();
+        m_index.flush();
+    }
+
+    bool MainChainStorageMmap::canPruneBlocks() const
+    {
+        return false;
+    }
+
+    void MainChainStorageMmap::pruneBlocks(uint32_t, uint32_t)
+    {
+        throw std::runtime_error("The mmap main chain storage can't be pruned");
+    }
+
+    System::MemoryMappedFile &MainChainStorageMmap::getSegment(const uint64_t segment) const
+    {
+        if (segment >= m_segments.size())
+        {
+            m_segments.resize(segment + 1);
+        }
+
+        auto &file = m_segments[segment];
+
+        if (!file)
+        {
+            const std::string filename = getSegmentFilename(m_directory, segment);
+
+            file = std::make_unique<System::MemoryMappedFile>();
+
+            if (fs::exists(filename))
+            {
+                file->open(filename);
+            }
+            else
+            {
+                file->create(filename, SEGMENT_SIZE, false);
+            }
+
+            if (file->size() != SEGMENT_SIZE)
+            {
+                file.reset();
+                throw std::runtime_error("Main chain storage segment " + filename + " has an unexpected size");
+            }
+        }
+
+        return *file;
+    }
+
+    uint64_t MainChainStorageMmap::getEndPosition() const
+    {
+        if (m_index.empty())
+        {
+            return 0;
+        }
+
+        uint32_t size;
+        getBlockData(static_cast<uint32_t>(m_index.size() - 1), size);
+
+        return m_index.back() + BLOCK_HEADER_SIZE + size;
+    }
+
+    const uint8_t *MainChainStorageMmap::getBlockData(const uint32_t index, uint32_t &size) const
+    {
+        const uint64_t position = m_index[index];
+
+        const uint8_t *data = getSegment(position / SEGMENT_SIZE).data() + position % SEGMENT_SIZE;
+
+        std::memcpy(&size, data, sizeof(size));
+
+        if (position % SEGMENT_SIZE + BLOCK_HEADER_SIZE + size > SEGMENT_SIZE)
+        {
+            throw std::runtime_error("Main chain storage is corrupt at block index " + std::to_string(index));
+        }
+
+        return data + BLOCK_HEADER_SIZE;
+    }
+
+    void MainChainStorageMmap::flush()
+    {
+        /* Only the segment being appended to can have unsynced blocks, bar
+           the rare push that started a new one */
+        if (!m_index.empty())
+        {
+            const uint64_t lastSegment = m_index.back() / SEGMENT_SIZE;
+
+            for (uint64_t segment = lastSegment > 0 ? lastSegment - 1 : 0; segment <= lastSegment; segment++)
+            {
+                auto &file = getSegment(segment);
+                file.flush(file.data(), file.size());
+            }
+        }
+
+        m_index.flush();
+
+        m_unflushedBlocks = 0;
+    }
+
+    std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageMmap(
+        const std::string &dataDir,
+        const Currency &currency,
+        const bool compressBlocks)
+    {
+        fs::path blocksDirectory = fs::path(dataDir) / currency.blocksFileName();
+
+        auto storage = std::make_unique<MainChainStorageMmap>(blocksDirectory.string() + ".mmap", compressBlocks);
+
+        if (storage->getBlockCount() == 0)
+        {
+            RawBlock genesisBlock;
+            genesisBlock.block = toBinaryArray(currency.genesisBlock());
+            storage->pushBlock(genesisBlock);
+        }
+
+        return storage;
+    }
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "IMainChainStorage.h"
+
+#include "Currency.h"
+
+#include "Common/FileMappedVector.h"
+
+#include "System/MemoryMappedFile.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* Stores the main chain in append only segment files, which are memory
+       mapped, along with a dense index of where each block starts. Reading a
+       block is a lookup in the index and a copy out of the mapping, with no
+       cache of our own in between - the page cache does that for us. */
+    class MainChainStorageMmap : public IMainChainStorage
+    {
+        public:
+            MainChainStorageMmap(const std::string &directory, const bool compressBlocks);
+
+            virtual ~MainChainStorageMmap();
+
+            virtual void pushBlock(const RawBlock &rawBlock) override;
+            virtual void popBlock() override;
+            virtual void rewindTo(const uint32_t index) const override;
+
+            virtual RawBlock getBlockByIndex(uint32_t index) const override;
+            virtual std::vector<RawBlock> getBlocksByIndexRange(uint32_t startIndex, uint32_t endIndex) const override;
+            virtual uint32_t getBlockCount() const override;
+
+            virtual void clear() override;
+
+            /* Blocks are appended one after another, so can't be rewritten
+               smaller in place */
+            virtual bool canPruneBlocks() const override;
+            virtual void pruneBlocks(uint32_t, uint32_t) override;
+
+        private:
+            /* Opens, or creates, the segment file, if we haven't already */
+            System::MemoryMappedFile &getSegment(const uint64_t segment) const;
+
+            /* The position just past the last block */
+            uint64_t getEndPosition() const;
+
+            /* Where the block is stored, and its size */
+            const uint8_t *getBlockData(const uint32_t index, uint32_t &size) const;
+
+            void flush();
+
+            std::string m_directory;
+
+            /* The position of each block. A position is its segment times the
+               segment size, plus its offset in that segment. */
+            mutable Common::FileMappedVector<uint64_t> m_index;
+
+            mutable std::vector<std::unique_ptr<System::MemoryMappedFile>> m_segments;
+
+            /* Blocks pushed since the segments and index were last flushed */
+            uint32_t m_unflushedBlocks = 0;
+
+            /* Whether newly stored blocks are LZ4 compressed */
+            const bool m_compressBlocks;
+
+            /* Growing the index remaps it, so readers must not run alongside
+               writers */
+            mutable std::mutex m_mutex;
+    };
+
+    std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageMmap(
+        const std::string &dataDir,
+        const Currency &currency,
+        const bool compressBlocks);
+}
@@ -4,21 +4,31 @@
 
 #include "MainChainStorageRocksdb.h"
 
-#include <Common/FileSystemShim.h>
+#include <algorithm>
 
-#include "rapidjson/writer.h"
-#include "rapidjson/stringbuffer.h"
+#include <Common/FileSystemShim.h>
 
 #include "Common/CryptoNoteTools.h"
 
+#include "RawBlockStorageFormat.h"
+
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/table.h"
 
-using namespace rapidjson;
 using namespace CryptoNote;
 
+namespace
+{
+    /* Number of blocks rewritten per write batch when migrating */
+    const uint32_t MIGRATION_BATCH_SIZE = 1000;
+
+    /* How every block is stored, whether pushed, migrated or pruned. The
+       blocks aren't compressed themselves, the tables already are when
+       database compression is enabled. */
+    const bool COMPRESS_BLOCKS = false;
+}
 
 namespace CryptoNote
 {
@@ -73,6 +83,8 @@ namespace CryptoNote
         
         /* initialize block count cache */
         initializeBlockCount();
+
+        initializePrunedHeight();
     }
 
     MainChainStorageRocksdb::~MainChainStorageRocksdb()
@@ -83,14 +95,12 @@ namespace CryptoNote
 
     void MainChainStorageRocksdb::pushBlock(const RawBlock &rawBlock)
     {
-        /* stringify RawBlock for storage **/
-        StringBuffer rblock;
-        Writer<StringBuffer> writer(rblock);
-        rawBlock.toJSON(writer);
+        const std::string rawBlockData = serializeRawBlock(rawBlock, COMPRESS_BLOCKS);
+
         rocksdb::WriteBatch batch;
         
         /* insert new block */
-        batch.Put(std::to_string(m_blockcount), rblock.GetString());
+        batch.Put(std::to_string(m_blockcount), rawBlockData);
         /* update the block count */
         batch.Put("count", std::to_string(m_blockcount+1));
         rocksdb::Status s = m_db->Write(rocksdb::WriteOptions(), &batch);
@@ -160,12 +170,23 @@ namespace CryptoNote
         }
       
         /* update block count, new count == rewind index/height */
-        s = m_db->Put(write_opts, "count", std::to_string(index));
+        rocksdb::WriteBatch batch;
+        batch.Put("count", std::to_string(index));
+
+        /* every block left is below the pruned height */
+        if (m_prunedHeight > index)
+        {
+            batch.Put("pruned_height", std::to_string(index));
+        }
+
+        s = m_db->Write(write_opts, &batch);
       
         if (!s.ok())
         {
             throw std::runtime_error("Rewind operation failed: " + s.ToString());
         }
+
+        m_prunedHeight = std::min<uint32_t>(m_prunedHeight, index);
       
         m_db->Flush(rocksdb::FlushOptions());
         m_db->SyncWAL();
@@ -182,17 +203,53 @@ namespace CryptoNote
             &rawBlockString
         );
         
-        /* parse it back to RawBlock */
-        Document doc;
-        if (doc.Parse<0>(rawBlockString.ToString()).HasParseError() ) {
-            throw std::runtime_error("Failed to get block by index: unable to parse block data");
+        if (!s.ok())
+        {
+            throw std::runtime_error("Failed to get block by index: " + s.ToString());
         }
-        
-        RawBlock rawBlock;
-        rawBlock.fromJSON(doc);
-        return rawBlock;
+
+        return deserializeRawBlock(rawBlockString.data(), rawBlockString.size());
     }
     
+    std::vector<RawBlock> MainChainStorageRocksdb::getBlocksByIndexRange(
+        const uint32_t startIndex,
+        const uint32_t endIndex) const
+    {
+        std::vector<RawBlock> rawBlocks;
+
+        if (startIndex >= endIndex)
+        {
+            return rawBlocks;
+        }
+
+        std::vector<std::string> keys;
+        keys.reserve(endIndex - startIndex);
+
+        for (uint32_t index = startIndex; index < endIndex; index++)
+        {
+            keys.push_back(std::to_string(index));
+        }
+
+        std::vector<rocksdb::Slice> keySlices(keys.begin(), keys.end());
+        std::vector<std::string> values;
+
+        const std::vector<rocksdb::Status> statuses = m_db->MultiGet(rocksdb::ReadOptions(), keySlices, &values);
+
+        rawBlocks.reserve(values.size());
+
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (!statuses[i].ok())
+            {
+                throw std::runtime_error("Failed to get block by index: " + statuses[i].ToString());
+            }
+
+            rawBlocks.push_back(deserializeRawBlock(values[i].data(), values[i].size()));
+        }
+
+        return rawBlocks;
+    }
+
     void MainChainStorageRocksdb::initializeBlockCount() 
     {
         m_blockcount = 0;
@@ -227,6 +284,29 @@ namespace CryptoNote
         return m_blockcount;        
     }
 
+    void MainChainStorageRocksdb::initializePrunedHeight()
+    {
+        m_prunedHeight = 0;
+
+        rocksdb::PinnableSlice prunedHeight;
+        rocksdb::Status s = m_db->Get(rocksdb::ReadOptions(), m_db->DefaultColumnFamily(), "pruned_height", &prunedHeight);
+
+        if (s.ok())
+        {
+            m_prunedHeight = std::stoul(prunedHeight.ToString());
+        }
+        /* never pruned, nothing to record */
+        else if (!s.IsNotFound())
+        {
+            throw std::runtime_error("Failed to initialize pruned height: " + s.ToString());
+        }
+    }
+
+    uint32_t MainChainStorageRocksdb::getPrunedHeight() const
+    {
+        return m_prunedHeight;
+    }
+
     void MainChainStorageRocksdb::clear()
     {
         /* do nothing if we don't have any block */
@@ -247,13 +327,110 @@ namespace CryptoNote
             throw std::runtime_error("Failed to clear blocks: " + s.ToString());
         }
         
-        s = m_db->Put(write_options, "count", "0");
+        rocksdb::WriteBatch batch;
+        batch.Put("count", "0");
+        batch.Put("pruned_height", "0");
+
+        s = m_db->Write(write_options, &batch);
         if (!s.ok())
         {
             throw std::runtime_error("Failed to update block count: " + s.ToString());
         }
         /* reset m_blockcount value */
         m_blockcount = 0;
+        m_prunedHeight = 0;
+    }
+
+    uint32_t MainChainStorageRocksdb::migrateRawBlocks()
+    {
+        uint32_t migrated = 0;
+
+        rocksdb::WriteBatch batch;
+
+        for (uint32_t index = 0; index < m_blockcount; index++)
+        {
+            rocksdb::PinnableSlice rawBlockString;
+            rocksdb::Status s = m_db->Get(
+                rocksdb::ReadOptions(),
+                m_db->DefaultColumnFamily(),
+                std::to_string(index),
+                &rawBlockString
+            );
+
+            if (!s.ok())
+            {
+                throw std::runtime_error("Failed to migrate block " + std::to_string(index) + ": " + s.ToString());
+            }
+
+            if (isLegacyRawBlock(rawBlockString.data(), rawBlockString.size()))
+            {
+                batch.Put(
+                    std::to_string(index),
+                    serializeRawBlock(deserializeRawBlock(rawBlockString.data(), rawBlockString.size()), COMPRESS_BLOCKS)
+                );
+
+                migrated++;
+            }
+
+            if (static_cast<uint32_t>(batch.Count()) >= MIGRATION_BATCH_SIZE || (index + 1 == m_blockcount && batch.Count() > 0))
+            {
+                s = m_db->Write(rocksdb::WriteOptions(), &batch);
+
+                if (!s.ok())
+                {
+                    throw std::runtime_error("Failed to write migrated blocks: " + s.ToString());
+                }
+
+                batch.Clear();
+            }
+        }
+
+        /* The old blocks are only dropped from disk on compaction */
+        if (migrated > 0)
+        {
+            m_db->CompactRange(rocksdb::CompactRangeOptions(), nullptr, nullptr);
+        }
+
+        return migrated;
+    }
+
+    bool MainChainStorageRocksdb::canPruneBlocks() const
+    {
+        return true;
+    }
+
+    void MainChainStorageRocksdb::pruneBlocks(const uint32_t startIndex, const uint32_t endIndex)
+    {
+        rocksdb::WriteBatch batch;
+
+        const uint32_t prunedHeight = std::max<uint32_t>(m_prunedHeight, std::min<uint32_t>(endIndex, m_blockcount));
+
+        uint32_t index = startIndex;
+
+        for (auto &rawBlock : getBlocksByIndexRange(startIndex, std::min<uint32_t>(endIndex, m_blockcount)))
+        {
+            if (!rawBlock.transactions.empty())
+            {
+                rawBlock.transactions.clear();
+                batch.Put(std::to_string(index), serializeRawBlock(rawBlock, COMPRESS_BLOCKS));
+            }
+
+            index++;
+        }
+
+        /* Written with the blocks, so the height is never behind what has
+           actually been pruned */
+        batch.Put("pruned_height", std::to_string(prunedHeight));
+
+        /* The space is reclaimed as the old blocks are compacted away */
+        rocksdb::Status s = m_db->Write(rocksdb::WriteOptions(), &batch);
+
+        if (!s.ok())
+        {
+            throw std::runtime_error("Failed to write pruned blocks: " + s.ToString());
+        }
+
+        m_prunedHeight = prunedHeight;
     }
 
     std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageRocksdb(
@@ -13,6 +13,7 @@
 #include "DataBaseConfig.h"
 
 #include <memory>
+#include <vector>
 
 namespace CryptoNote
 {
@@ -32,15 +33,26 @@ namespace CryptoNote
             virtual void rewindTo(const uint32_t index) const override;
 
             virtual RawBlock getBlockByIndex(const uint32_t index) const override;
+            virtual std::vector<RawBlock> getBlocksByIndexRange(uint32_t startIndex, uint32_t endIndex) const override;
             virtual uint32_t getBlockCount() const override;
 
             virtual void clear() override;
-            
+
+            virtual uint32_t migrateRawBlocks() override;
+
+            virtual bool canPruneBlocks() const override;
+
+            virtual void pruneBlocks(uint32_t startIndex, uint32_t endIndex) override;
+
+            virtual uint32_t getPrunedHeight() const override;
 
         private:
             void initializeBlockCount();
+            void initializePrunedHeight();
             std::unique_ptr<rocksdb::DB> m_db;
             mutable std::atomic_uint m_blockcount;
+            /* mutable as rewindTo() may lower it */
+            mutable std::atomic_uint m_prunedHeight;
     };
 
     std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageRocksdb(
@@ -4,19 +4,54 @@
 
 #include "MainChainStorageSqlite.h"
 
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
 #include <Common/CryptoNoteTools.h>
 #include <Common/FileSystemShim.h>
 
-#include "rapidjson/writer.h"
-#include "rapidjson/stringbuffer.h"
+#include "RawBlockStorageFormat.h"
 
 #include "sqlite3.h"
 
-using namespace rapidjson;
-
 namespace CryptoNote
 {
-    MainChainStorageSqlite::MainChainStorageSqlite(const std::string &blocksFilename, const std::string &indexesFilename)
+    namespace
+    {
+        /* Number of blocks rewritten per transaction when migrating */
+        const uint32_t MIGRATION_BATCH_SIZE = 1000;
+
+        /* Pushed blocks are committed once this many are pending, or once
+           the oldest pending block is this old, whichever comes first */
+        const uint32_t BLOCKS_PER_TRANSACTION = 100;
+        const std::chrono::seconds MAX_TRANSACTION_AGE = std::chrono::seconds(5);
+
+        sqlite3_stmt *prepareStatement(sqlite3 *db, const char *sql)
+        {
+            sqlite3_stmt *stmt;
+
+            if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK)
+            {
+                throw std::runtime_error(std::string("Failed to prepare statement: ") + sqlite3_errmsg(db));
+            }
+
+            return stmt;
+        }
+
+        /* Ready a kept statement for its next use */
+        void resetStatement(sqlite3_stmt *stmt)
+        {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    }
+
+    MainChainStorageSqlite::MainChainStorageSqlite(
+        const std::string &blocksFilename,
+        const std::string &indexesFilename,
+        const bool compressBlocks) :
+        m_compressBlocks(compressBlocks)
     {
         int resultCode = sqlite3_open(blocksFilename.c_str(), &m_db);
 
@@ -28,7 +63,23 @@ namespace CryptoNote
 
         resultCode = sqlite3_exec(
                          m_db,
-                         "CREATE TABLE IF NOT EXISTS `rawBlocks` ( `blockIndex` INTEGER NOT NULL DEFAULT 0 PRIMARY KEY, `rawBlock` TEXT )",
+                         "CREATE TABLE IF NOT EXISTS `rawBlocks` ( `blockIndex` INTEGER NOT NULL DEFAULT 0 PRIMARY KEY, `rawBlock` BLOB )",
+                         NULL,
+                         NULL,
+                         NULL
+        );
+
+        if (resultCode != SQLITE_OK)
+        {
+            sqlite3_close(m_db);
+            throw std::runtime_error("Failed to create database table");
+        }
+
+        /* Holds the pruned height, which has to outlive the DB, as the DB
+           can't be rebuilt from pruned blocks */
+        resultCode = sqlite3_exec(
+                         m_db,
+                         "CREATE TABLE IF NOT EXISTS `metadata` ( `key` TEXT NOT NULL PRIMARY KEY, `value` INTEGER NOT NULL )",
                          NULL,
                          NULL,
                          NULL
@@ -57,204 +108,499 @@ namespace CryptoNote
             sqlite3_close(m_db);
             throw std::runtime_error("Failed to set database PRAGMA");
         }
+
+        try
+        {
+            m_insertStatement = prepareStatement(m_db, "INSERT INTO rawBlocks (blockIndex, rawBlock) VALUES (?1, ?2)");
+            m_deleteStatement = prepareStatement(m_db, "DELETE FROM rawBlocks WHERE blockIndex >= ?1");
+            m_selectStatement = prepareStatement(m_db, "SELECT rawBlock FROM rawBlocks WHERE blockIndex = ?1 LIMIT 1");
+            m_selectRangeStatement = prepareStatement(
+                m_db,
+                "SELECT rawBlock FROM rawBlocks WHERE blockIndex >= ?1 AND blockIndex < ?2 ORDER BY blockIndex"
+            );
+
+            m_blockCount = queryBlockCount();
+            m_prunedHeight = queryPrunedHeight();
+        }
+        catch (const std::exception &)
+        {
+            finalizeStatements();
+            sqlite3_close(m_db);
+            throw;
+        }
     }
 
     MainChainStorageSqlite::~MainChainStorageSqlite()
     {
+        /* Don't lose the blocks pushed since the last commit, but a
+           destructor mustn't throw */
+        try
+        {
+            commitTransaction();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to commit blocks on shutdown, they'll be imported again on startup: " << e.what() << std::endl;
+        }
+
+        finalizeStatements();
+
         sqlite3_close(m_db);
     }
 
     void MainChainStorageSqlite::pushBlock(const RawBlock &rawBlock)
     {
-        sqlite3_stmt *stmt;
+        const std::string rawBlockData = serializeRawBlock(rawBlock, m_compressBlocks);
 
-        /* Convert the RawBlock to a json structure for easier storage */
-        StringBuffer sb;
-        Writer<StringBuffer> writer(sb);
-        rawBlock.toJSON(writer);
-        std::string rawBlockHex = sb.GetString();
+        /* Committing every insert on its own is what makes sqlite slow, so
+           pushed blocks are grouped into transactions. A crash loses at most
+           the uncommitted blocks, which Core::load() handles like any other
+           main chain storage that is behind the DB. */
+        beginTransaction();
 
-        /* We get the current count of blocks which, as we're a 0-based index
-           technically gives us the next blockIndex that we're pushing into
-           the database */
-        const uint32_t nextBlockIndex = getBlockCount();
+        resetStatement(m_insertStatement);
 
-        const int resultCode = sqlite3_prepare_v2(m_db, "INSERT INTO rawBlocks (blockIndex, rawBlock) VALUES (?,?)", -1, &stmt, NULL);
+        /* We're a 0-based index, so the block count is the blockIndex of
+           the block we're pushing */
+        sqlite3_bind_int(m_insertStatement, 1, m_blockCount);
+        sqlite3_bind_blob(m_insertStatement, 2, rawBlockData.data(), static_cast<int>(rawBlockData.size()), SQLITE_STATIC);
 
-        if (resultCode != SQLITE_OK)
+        if (sqlite3_step(m_insertStatement) != SQLITE_DONE)
         {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to prepare insert block statement");
-        }
+            /* Don't leave behind an empty transaction we think isn't open */
+            if (m_transactionBlocks == 0)
+            {
+                sqlite3_exec(m_db, "ROLLBACK TRANSACTION", NULL, NULL, NULL);
+            }
 
-        sqlite3_bind_int(stmt, 1, nextBlockIndex);
-        sqlite3_bind_text(stmt, 2, rawBlockHex.c_str(), -1, 0);
+            throw std::runtime_error(std::string("Failed to insert block: ") + sqlite3_errmsg(m_db));
+        }
 
-        sqlite3_step(stmt);
+        m_blockCount++;
+        m_transactionBlocks++;
 
-        sqlite3_finalize(stmt);
+        if (m_transactionBlocks >= BLOCKS_PER_TRANSACTION
+         || std::chrono::steady_clock::now() - m_transactionStart >= MAX_TRANSACTION_AGE)
+        {
+            commitTransaction();
+        }
     }
 
     void MainChainStorageSqlite::popBlock()
     {
-        const int resultCode = sqlite3_exec(
-                                  m_db,
-                                  "DELETE FROM rawBlocks WHERE blockIndex = (SELECT MAX(blockIndex) FROM rawBlocks)",
-                                  NULL,
-                                  NULL,
-                                  NULL
-        );
-
-        if (resultCode != SQLITE_OK)
+        if (m_blockCount == 0)
         {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to pop the last block off the database");
+            return;
         }
+
+        deleteFrom(m_blockCount - 1);
     }
-    
+
     void MainChainStorageSqlite::rewindTo(const uint32_t index) const
     {
-        uint32_t maxBlocks = getBlockCount();
-        if( index >= maxBlocks ) {
+        if (index >= m_blockCount)
+        {
             return;
         }
-        
-        sqlite3_stmt *stmt;
-        int resultCode = sqlite3_prepare_v2(
-            m_db, 
-            "DELETE FROM rawBlocks WHERE blockIndex >= ?1",
-            -1,
-            &stmt,
-            NULL
-        );
-        
-        sqlite3_bind_int(stmt, 1, index);
-        
-        if (resultCode != SQLITE_OK)
+
+        deleteFrom(index);
+    }
+
+    void MainChainStorageSqlite::deleteFrom(const uint32_t index) const
+    {
+        /* Removing blocks means a chain switch or a rewind, commit the blocks
+           pending before them so they can't be reordered */
+        commitTransaction();
+
+        resetStatement(m_deleteStatement);
+
+        sqlite3_bind_int(m_deleteStatement, 1, index);
+
+        if (sqlite3_step(m_deleteStatement) != SQLITE_DONE)
         {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to prepare rewind statement");
+            throw std::runtime_error(std::string("Failed to remove blocks from the database: ") + sqlite3_errmsg(m_db));
         }
-        
-        resultCode = sqlite3_step(stmt);
-        if(resultCode != SQLITE_DONE) {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to perform rewind operation");
+
+        m_blockCount = index;
+
+        if (m_prunedHeight > index)
+        {
+            writePrunedHeight(index);
         }
-        
-        sqlite3_finalize(stmt);
     }
 
     RawBlock MainChainStorageSqlite::getBlockByIndex(uint32_t index) const
     {
-        sqlite3_stmt *stmt;
-        
-        /* Go get how many blocks we have in the local blockchain cache */
-        const uint32_t maxBlocks = getBlockCount();
-
-        /* As we're a 0-based index and getBlockCount() returns the total
-           number of blocks in the blockchain cache we need to account for
-           that when checking to see that we aren't requesting a blockindex
-           that we don't have in the blockchain cache */
-        if (index > (maxBlocks - 1))
+        if (index >= m_blockCount)
         {
             throw std::runtime_error("Cannot retrieve a block at an index higher than what we have");
         }
 
-        int resultCode = sqlite3_prepare_v2(m_db, "SELECT rawBlock FROM rawBlocks WHERE blockIndex = ? LIMIT 1", -1, &stmt, NULL);
+        resetStatement(m_selectStatement);
 
-        sqlite3_bind_int(stmt, 1, index);
+        sqlite3_bind_int(m_selectStatement, 1, index);
 
-        if (resultCode != SQLITE_OK)
+        const int resultCode = sqlite3_step(m_selectStatement);
+
+        /* If for some reason we did not find a block in our query results, error out
+           as this likely means that the database has a data integrity issue */
+        if (resultCode == SQLITE_DONE)
         {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to prepare getBlockByIndex statement");
+            throw std::runtime_error("Could not find block in cache for given blockIndex");
         }
 
-        bool found = false;
-        
-        /* Loop through the results to see if we got a block back */
-        RawBlock rawBlock;
-        Document doc;
-        while((resultCode = sqlite3_step(stmt)) == SQLITE_ROW)
+        if (resultCode != SQLITE_ROW)
         {
-            if ( !doc.Parse<0>(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)) ).HasParseError() )
-            {
-                rawBlock.fromJSON(doc);
-                found = true;
-            }
+            throw std::runtime_error("Failed to properly to retrieve rawBlock in getBlockByIndex");
         }
 
-        if (resultCode != SQLITE_DONE)
+        return deserializeRawBlock(
+            static_cast<const char *>(sqlite3_column_blob(m_selectStatement, 0)),
+            static_cast<size_t>(sqlite3_column_bytes(m_selectStatement, 0))
+        );
+    }
+
+    std::vector<RawBlock> MainChainStorageSqlite::getBlocksByIndexRange(
+        const uint32_t startIndex,
+        const uint32_t endIndex) const
+    {
+        if (endIndex > m_blockCount)
         {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to properly to retrieve rawBlock in getBlockByIndex");
+            throw std::runtime_error("Cannot retrieve blocks at an index higher than what we have");
         }
 
-        sqlite3_finalize(stmt);
+        std::vector<RawBlock> rawBlocks;
 
-        /* If for some reason we did not find a block in our query results, error out
-           as this likely means that the database has a data integrity issue */
-        if (!found)
+        if (startIndex >= endIndex)
         {
-            throw std::runtime_error("Could not find block in cache for given blockIndex");
+            return rawBlocks;
+        }
+
+        rawBlocks.reserve(endIndex - startIndex);
+
+        resetStatement(m_selectRangeStatement);
+
+        sqlite3_bind_int(m_selectRangeStatement, 1, startIndex);
+        sqlite3_bind_int(m_selectRangeStatement, 2, endIndex);
+
+        int resultCode;
+
+        while ((resultCode = sqlite3_step(m_selectRangeStatement)) == SQLITE_ROW)
+        {
+            rawBlocks.push_back(deserializeRawBlock(
+                static_cast<const char *>(sqlite3_column_blob(m_selectRangeStatement, 0)),
+                static_cast<size_t>(sqlite3_column_bytes(m_selectRangeStatement, 0))
+            ));
         }
 
-        return rawBlock;
+        if (resultCode != SQLITE_DONE)
+        {
+            throw std::runtime_error("Failed to properly retrieve rawBlocks in getBlocksByIndexRange");
+        }
+
+        if (rawBlocks.size() != endIndex - startIndex)
+        {
+            throw std::runtime_error("Could not find all blocks in cache for given blockIndex range");
+        }
+
+        return rawBlocks;
     }
 
     uint32_t MainChainStorageSqlite::getBlockCount() const
     {
-        sqlite3_stmt *stmt;
-        size_t blockCount = 0;
+        return m_blockCount;
+    }
 
-        int resultCode = sqlite3_prepare_v2(m_db, "SELECT COUNT(*) AS blockCount FROM rawBlocks", -1, &stmt, NULL);
+    void MainChainStorageSqlite::clear()
+    {
+        deleteFrom(0);
+    }
 
-        if (resultCode != SQLITE_OK)
-        {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to prepare getBlockCount statement");
-        }
+    uint32_t MainChainStorageSqlite::queryBlockCount() const
+    {
+        sqlite3_stmt *stmt = prepareStatement(m_db, "SELECT COUNT(*) AS blockCount FROM rawBlocks");
+
+        uint32_t blockCount = 0;
+
+        int resultCode;
 
         while((resultCode = sqlite3_step(stmt)) == SQLITE_ROW)
         {
-            blockCount = sqlite3_column_int(stmt, 0);
+            blockCount = static_cast<uint32_t>(sqlite3_column_int(stmt, 0));
         }
 
+        sqlite3_finalize(stmt);
+
         if (resultCode != SQLITE_DONE)
         {
-            sqlite3_close(m_db);
             throw std::runtime_error("Failed to properly retrieve block count in getBlockCount");
         }
 
+        return blockCount;
+    }
+
+    uint32_t MainChainStorageSqlite::getPrunedHeight() const
+    {
+        return m_prunedHeight;
+    }
+
+    uint32_t MainChainStorageSqlite::queryPrunedHeight() const
+    {
+        sqlite3_stmt *stmt = prepareStatement(m_db, "SELECT value FROM metadata WHERE key = 'prunedHeight'");
+
+        uint32_t prunedHeight = 0;
+
+        int resultCode;
+
+        while ((resultCode = sqlite3_step(stmt)) == SQLITE_ROW)
+        {
+            prunedHeight = static_cast<uint32_t>(sqlite3_column_int(stmt, 0));
+        }
+
         sqlite3_finalize(stmt);
 
-        return blockCount;
+        if (resultCode != SQLITE_DONE)
+        {
+            throw std::runtime_error("Failed to properly retrieve pruned height in queryPrunedHeight");
+        }
+
+        return prunedHeight;
     }
 
-    void MainChainStorageSqlite::clear()
+    void MainChainStorageSqlite::writePrunedHeight(const uint32_t prunedHeight) const
     {
-        const int resultCode = sqlite3_exec(
-                                  m_db,
-                                  "DELETE FROM rawBlocks",
-                                  NULL,
-                                  NULL,
-                                  NULL
+        sqlite3_stmt *stmt = prepareStatement(
+            m_db,
+            "INSERT OR REPLACE INTO metadata (key, value) VALUES ('prunedHeight', ?1)"
         );
 
-        if (resultCode != SQLITE_OK)
+        sqlite3_bind_int(stmt, 1, prunedHeight);
+
+        const int resultCode = sqlite3_step(stmt);
+
+        sqlite3_finalize(stmt);
+
+        if (resultCode != SQLITE_DONE)
         {
-            sqlite3_close(m_db);
-            throw std::runtime_error("Failed to delete all blocks from the database");
+            throw std::runtime_error(std::string("Failed to update pruned height: ") + sqlite3_errmsg(m_db));
+        }
+
+        m_prunedHeight = prunedHeight;
+    }
+
+    void MainChainStorageSqlite::commit()
+    {
+        commitTransaction();
+    }
+
+    void MainChainStorageSqlite::beginTransaction()
+    {
+        if (m_transactionBlocks > 0)
+        {
+            return;
+        }
+
+        if (sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL) != SQLITE_OK)
+        {
+            throw std::runtime_error(std::string("Failed to begin transaction: ") + sqlite3_errmsg(m_db));
+        }
+
+        m_transactionStart = std::chrono::steady_clock::now();
+    }
+
+    void MainChainStorageSqlite::commitTransaction() const
+    {
+        if (m_transactionBlocks == 0)
+        {
+            return;
+        }
+
+        if (sqlite3_exec(m_db, "COMMIT TRANSACTION", NULL, NULL, NULL) != SQLITE_OK)
+        {
+            throw std::runtime_error(std::string("Failed to commit transaction: ") + sqlite3_errmsg(m_db));
+        }
+
+        m_transactionBlocks = 0;
+    }
+
+    void MainChainStorageSqlite::finalizeStatements()
+    {
+        /* Finalizing a null statement is a no-op */
+        sqlite3_finalize(m_insertStatement);
+        sqlite3_finalize(m_deleteStatement);
+        sqlite3_finalize(m_selectStatement);
+        sqlite3_finalize(m_selectRangeStatement);
+    }
+
+    uint32_t MainChainStorageSqlite::migrateRawBlocks()
+    {
+        commitTransaction();
+
+        uint32_t migrated = 0;
+
+        for (uint32_t startIndex = 0; startIndex < m_blockCount; startIndex += MIGRATION_BATCH_SIZE)
+        {
+            const uint32_t endIndex = std::min(m_blockCount, startIndex + MIGRATION_BATCH_SIZE);
+
+            /* Read the whole batch before updating, so we are never modifying
+               the table we are stepping through */
+            std::vector<std::pair<uint32_t, std::string>> legacyBlocks;
+
+            sqlite3_stmt *stmt = prepareStatement(
+                m_db,
+                "SELECT blockIndex, rawBlock FROM rawBlocks WHERE blockIndex >= ?1 AND blockIndex < ?2"
+            );
+
+            sqlite3_bind_int(stmt, 1, startIndex);
+            sqlite3_bind_int(stmt, 2, endIndex);
+
+            int resultCode;
+
+            while ((resultCode = sqlite3_step(stmt)) == SQLITE_ROW)
+            {
+                const char *data = static_cast<const char *>(sqlite3_column_blob(stmt, 1));
+                const size_t size = static_cast<size_t>(sqlite3_column_bytes(stmt, 1));
+
+                if (isLegacyRawBlock(data, size))
+                {
+                    legacyBlocks.emplace_back(
+                        sqlite3_column_int(stmt, 0),
+                        serializeRawBlock(deserializeRawBlock(data, size), m_compressBlocks)
+                    );
+                }
+            }
+
+            sqlite3_finalize(stmt);
+
+            if (resultCode != SQLITE_DONE)
+            {
+                throw std::runtime_error("Failed to properly retrieve blocks in migrateRawBlocks");
+            }
+
+            if (legacyBlocks.empty())
+            {
+                continue;
+            }
+
+            if (sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL) != SQLITE_OK)
+            {
+                throw std::runtime_error(std::string("Failed to begin transaction in migrateRawBlocks: ") + sqlite3_errmsg(m_db));
+            }
+
+            stmt = prepareStatement(m_db, "UPDATE rawBlocks SET rawBlock = ?1 WHERE blockIndex = ?2");
+
+            for (const auto &[blockIndex, rawBlockData] : legacyBlocks)
+            {
+                sqlite3_bind_blob(stmt, 1, rawBlockData.data(), static_cast<int>(rawBlockData.size()), SQLITE_STATIC);
+                sqlite3_bind_int(stmt, 2, blockIndex);
+
+                if (sqlite3_step(stmt) != SQLITE_DONE)
+                {
+                    sqlite3_finalize(stmt);
+                    sqlite3_exec(m_db, "ROLLBACK TRANSACTION", NULL, NULL, NULL);
+                    throw std::runtime_error("Failed to update block in migrateRawBlocks");
+                }
+
+                sqlite3_reset(stmt);
+            }
+
+            sqlite3_finalize(stmt);
+
+            if (sqlite3_exec(m_db, "COMMIT TRANSACTION", NULL, NULL, NULL) != SQLITE_OK)
+            {
+                throw std::runtime_error("Failed to commit migrated blocks");
+            }
+
+            migrated += static_cast<uint32_t>(legacyBlocks.size());
+        }
+
+        return migrated;
+    }
+
+    bool MainChainStorageSqlite::canPruneBlocks() const
+    {
+        return true;
+    }
+
+    void MainChainStorageSqlite::pruneBlocks(const uint32_t startIndex, const uint32_t endIndex)
+    {
+        commitTransaction();
+
+        std::vector<std::pair<uint32_t, std::string>> prunedBlocks;
+
+        const uint32_t prunedHeight = std::max(m_prunedHeight, std::min(endIndex, m_blockCount));
+
+        uint32_t blockIndex = startIndex;
+
+        for (auto &rawBlock : getBlocksByIndexRange(startIndex, std::min(endIndex, m_blockCount)))
+        {
+            if (!rawBlock.transactions.empty())
+            {
+                rawBlock.transactions.clear();
+                prunedBlocks.emplace_back(blockIndex, serializeRawBlock(rawBlock, m_compressBlocks));
+            }
+
+            blockIndex++;
+        }
+
+        /* The freed pages are reused for the blocks pushed after, rather
+           than the file shrinking */
+        if (sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL) != SQLITE_OK)
+        {
+            throw std::runtime_error(std::string("Failed to begin transaction in pruneBlocks: ") + sqlite3_errmsg(m_db));
+        }
+
+        sqlite3_stmt *stmt = prepareStatement(m_db, "UPDATE rawBlocks SET rawBlock = ?1 WHERE blockIndex = ?2");
+
+        for (const auto &[index, rawBlockData] : prunedBlocks)
+        {
+            sqlite3_bind_blob(stmt, 1, rawBlockData.data(), static_cast<int>(rawBlockData.size()), SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 2, index);
+
+            if (sqlite3_step(stmt) != SQLITE_DONE)
+            {
+                sqlite3_finalize(stmt);
+                sqlite3_exec(m_db, "ROLLBACK TRANSACTION", NULL, NULL, NULL);
+                throw std::runtime_error("Failed to update block in pruneBlocks");
+            }
+
+            sqlite3_reset(stmt);
+        }
+
+        sqlite3_finalize(stmt);
+
+        /* Recorded along with the blocks, so the height is never behind
+           what has actually been pruned */
+        try
+        {
+            writePrunedHeight(prunedHeight);
+        }
+        catch (const std::exception &)
+        {
+            sqlite3_exec(m_db, "ROLLBACK TRANSACTION", NULL, NULL, NULL);
+            m_prunedHeight = queryPrunedHeight();
+            throw;
+        }
+
+        if (sqlite3_exec(m_db, "COMMIT TRANSACTION", NULL, NULL, NULL) != SQLITE_OK)
+        {
+            throw std::runtime_error("Failed to commit pruned blocks");
         }
     }
 
-    std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageSqlite(const std::string &dataDir, const Currency &currency)
+    std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageSqlite(
+        const std::string &dataDir,
+        const Currency &currency,
+        const bool compressBlocks)
     {
         fs::path blocksFilename = fs::path(dataDir) / currency.blocksFileName();
         fs::path indexesFilename = fs::path(dataDir) / currency.blockIndexesFileName();
 
-        auto storage = std::make_unique<MainChainStorageSqlite>(blocksFilename.string() + ".sqlite3", indexesFilename.string());
+        auto storage = std::make_unique<MainChainStorageSqlite>(
+            blocksFilename.string() + ".sqlite3",
+            indexesFilename.string(),
+            compressBlocks
+        );
 
         if (storage->getBlockCount() == 0)
         {
@@ -10,12 +10,18 @@
 
 #include "sqlite3.h"
 
+#include <chrono>
+#include <vector>
+
 namespace CryptoNote
 {
     class MainChainStorageSqlite : public IMainChainStorage
     {
         public:
-            MainChainStorageSqlite(const std::string &blocksFilename, const std::string &indexesFilename);
+            MainChainStorageSqlite(
+                const std::string &blocksFilename,
+                const std::string &indexesFilename,
+                const bool compressBlocks);
 
             virtual ~MainChainStorageSqlite();
 
@@ -24,13 +30,65 @@ namespace CryptoNote
             void rewindTo(const uint32_t index) const override;
 
             virtual RawBlock getBlockByIndex(uint32_t index) const override;
+            virtual std::vector<RawBlock> getBlocksByIndexRange(uint32_t startIndex, uint32_t endIndex) const override;
             virtual uint32_t getBlockCount() const override;
 
             virtual void clear() override;
 
+            virtual void commit() override;
+
+            virtual uint32_t migrateRawBlocks() override;
+
+            virtual bool canPruneBlocks() const override;
+
+            virtual void pruneBlocks(uint32_t startIndex, uint32_t endIndex) override;
+
+            virtual uint32_t getPrunedHeight() const override;
+
         private:
+            /* Removes the blocks from index onwards */
+            void deleteFrom(const uint32_t index) const;
+
+            uint32_t queryBlockCount() const;
+
+            uint32_t queryPrunedHeight() const;
+
+            /* Not in a transaction of its own, so it commits along with
+               whatever is being written */
+            void writePrunedHeight(const uint32_t prunedHeight) const;
+
+            void beginTransaction();
+            void commitTransaction() const;
+
+            void finalizeStatements();
+
             sqlite3 *m_db;
+
+            /* Prepared once and reused, rather than for every call */
+            sqlite3_stmt *m_insertStatement = nullptr;
+            sqlite3_stmt *m_deleteStatement = nullptr;
+            sqlite3_stmt *m_selectStatement = nullptr;
+            sqlite3_stmt *m_selectRangeStatement = nullptr;
+
+            /* Only we write to the database, so the count is kept here instead
+               of being queried. Mutable as rewindTo() is const. */
+            mutable uint32_t m_blockCount = 0;
+
+            /* Blocks below this have been pruned. Mutable as rewindTo() may
+               lower it. */
+            mutable uint32_t m_prunedHeight = 0;
+
+            /* Blocks pushed in the open transaction, if any */
+            mutable uint32_t m_transactionBlocks = 0;
+
+            std::chrono::steady_clock::time_point m_transactionStart;
+
+            /* Whether newly stored blocks are LZ4 compressed */
+            const bool m_compressBlocks;
     };
 
-    std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageSqlite(const std::string &dataDir, const Currency &currency);
+    std::unique_ptr<IMainChainStorage> createSwappedMainChainStorageSqlite(
+        const std::string &dataDir,
+        const Currency &currency,
+        const bool compressBlocks);
 }
\ No newline at end of file
@@ -0,0 +1,203 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "RawBlockStorageFormat.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "lz4.h"
+
+#include "rapidjson/document.h"
+
+namespace CryptoNote
+{
+    namespace
+    {
+        const uint8_t RAW_BLOCK_FORMAT_VERSION = 1;
+
+        const uint8_t RAW_BLOCK_FLAG_LZ4 = 1;
+
+        /* Version byte, flags byte */
+        const size_t RAW_BLOCK_HEADER_SIZE = 2;
+
+        void writeSize(std::string &out, const size_t size)
+        {
+            const uint32_t size32 = static_cast<uint32_t>(size);
+            out.append(reinterpret_cast<const char *>(&size32), sizeof(size32));
+        }
+
+        uint32_t readSize(const char *&data, const char *end)
+        {
+            uint32_t size;
+
+            if (static_cast<size_t>(end - data) < sizeof(size))
+            {
+                throw std::runtime_error("Failed to deserialize raw block: unexpected end of data");
+            }
+
+            std::memcpy(&size, data, sizeof(size));
+            data += sizeof(size);
+
+            return size;
+        }
+
+        void readBlob(const char *&data, const char *end, BinaryArray &blob)
+        {
+            const uint32_t size = readSize(data, end);
+
+            if (static_cast<size_t>(end - data) < size)
+            {
+                throw std::runtime_error("Failed to deserialize raw block: unexpected end of data");
+            }
+
+            blob.resize(size);
+            std::memcpy(blob.data(), data, size);
+            data += size;
+        }
+
+        RawBlock readPayload(const char *data, const char *end)
+        {
+            RawBlock rawBlock;
+
+            readBlob(data, end, rawBlock.block);
+
+            const uint32_t transactionCount = readSize(data, end);
+
+            /* Each transaction needs at least its size, don't let a corrupt
+               count make us reserve gigabytes */
+            if (static_cast<size_t>(end - data) / sizeof(uint32_t) < transactionCount)
+            {
+                throw std::runtime_error("Failed to deserialize raw block: transaction count is too large");
+            }
+
+            rawBlock.transactions.resize(transactionCount);
+
+            for (auto &transaction : rawBlock.transactions)
+            {
+                readBlob(data, end, transaction);
+            }
+
+            return rawBlock;
+        }
+    }
+
+    std::string serializeRawBlock(const RawBlock &rawBlock, const bool compress)
+    {
+        size_t payloadSize = sizeof(uint32_t) * (rawBlock.transactions.size() + 2) + rawBlock.block.size();
+
+        for (const auto &transaction : rawBlock.transactions)
+        {
+            payloadSize += transaction.size();
+        }
+
+        std::string payload;
+        payload.reserve(payloadSize);
+
+        writeSize(payload, rawBlock.block.size());
+        payload.append(reinterpret_cast<const char *>(rawBlock.block.data()), rawBlock.block.size());
+
+        writeSize(payload, rawBlock.transactions.size());
+
+        for (const auto &transaction : rawBlock.transactions)
+        {
+            writeSize(payload, transaction.size());
+            payload.append(reinterpret_cast<const char *>(transaction.data()), transaction.size());
+        }
+
+        std::string result;
+
+        if (compress)
+        {
+            const int bound = LZ4_compressBound(static_cast<int>(payload.size()));
+
+            result.resize(RAW_BLOCK_HEADER_SIZE + sizeof(uint32_t) + bound);
+
+            const int compressedSize = LZ4_compress_default(
+                payload.data(),
+                &result[RAW_BLOCK_HEADER_SIZE + sizeof(uint32_t)],
+                static_cast<int>(payload.size()),
+                bound
+            );
+
+            /* Small blocks (mostly just a coinbase) often don't compress, in
+               which case we store them as is */
+            if (compressedSize > 0 && static_cast<size_t>(compressedSize) + sizeof(uint32_t) < payload.size())
+            {
+                const uint32_t uncompressedSize = static_cast<uint32_t>(payload.size());
+
+                result[0] = static_cast<char>(RAW_BLOCK_FORMAT_VERSION);
+                result[1] = static_cast<char>(RAW_BLOCK_FLAG_LZ4);
+                std::memcpy(&result[RAW_BLOCK_HEADER_SIZE], &uncompressedSize, sizeof(uncompressedSize));
+                result.resize(RAW_BLOCK_HEADER_SIZE + sizeof(uint32_t) + compressedSize);
+
+                return result;
+            }
+
+            result.clear();
+        }
+
+        result.reserve(RAW_BLOCK_HEADER_SIZE + payload.size());
+        result.push_back(static_cast<char>(RAW_BLOCK_FORMAT_VERSION));
+        result.push_back(0);
+        result.append(payload);
+
+        return result;
+    }
+
+    RawBlock deserializeRawBlock(const char *data, const size_t size)
+    {
+        if (isLegacyRawBlock(data, size))
+        {
+            rapidjson::Document doc;
+
+            if (doc.Parse<0>(data, size).HasParseError())
+            {
+                throw std::runtime_error("Failed to deserialize raw block: unable to parse block data");
+            }
+
+            RawBlock rawBlock;
+            rawBlock.fromJSON(doc);
+            return rawBlock;
+        }
+
+        if (size < RAW_BLOCK_HEADER_SIZE || static_cast<uint8_t>(data[0]) != RAW_BLOCK_FORMAT_VERSION)
+        {
+            throw std::runtime_error("Failed to deserialize raw block: unknown format version");
+        }
+
+        const uint8_t flags = static_cast<uint8_t>(data[1]);
+
+        const char *payload = data + RAW_BLOCK_HEADER_SIZE;
+        const char *end = data + size;
+
+        if ((flags & RAW_BLOCK_FLAG_LZ4) == 0)
+        {
+            return readPayload(payload, end);
+        }
+
+        const uint32_t uncompressedSize = readSize(payload, end);
+
+        std::string uncompressed(uncompressedSize, '\0');
+
+        const int result = LZ4_decompress_safe(
+            payload,
+            &uncompressed[0],
+            static_cast<int>(end - payload),
+            static_cast<int>(uncompressedSize)
+        );
+
+        if (result < 0 || static_cast<uint32_t>(result) != uncompressedSize)
+        {
+            throw std::runtime_error("Failed to deserialize raw block: corrupt compressed data");
+        }
+
+        return readPayload(uncompressed.data(), uncompressed.data() + uncompressed.size());
+    }
+
+    bool isLegacyRawBlock(const char *data, const size_t size)
+    {
+        return size > 0 && data[0] == '{';
+    }
+}
@@ -0,0 +1,29 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoNote.h>
+
+#include <string>
+
+namespace CryptoNote
+{
+    /* The on disk format of the raw blocks kept by the sqlite and rocksdb main
+       chain storages. A stored block starts with a version byte and a flags
+       byte, followed by the block and transaction blobs, each prefixed with
+       its size. The blobs can optionally be LZ4 compressed as a whole.
+
+       Blocks stored by older versions are rapidjson text with hex blobs. As
+       json always starts with a '{', these can't be mistaken for a binary
+       block, and are still read, until they are rewritten by
+       migrateRawBlocks() */
+    std::string serializeRawBlock(const RawBlock &rawBlock, const bool compress);
+
+    /* Throws if the data is neither a binary nor a json block */
+    RawBlock deserializeRawBlock(const char *data, const size_t size);
+
+    /* Whether the data is a block in the json format of older versions */
+    bool isLegacyRawBlock(const char *data, const size_t size);
+}
@@ -0,0 +1,397 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+
+#include <Common/CryptoNoteTools.h>
+#include <Common/FileSystemShim.h>
+#include <Common/StringTools.h>
+
+#include <crypto/hash.h>
+
+#include <JsonHelper.h>
+
+#include "CachedBlock.h"
+#include "RawBlockStorageFormat.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+
+namespace CryptoNote
+{
+    namespace
+    {
+        const uint64_t SNAPSHOT_VERSION = 1;
+
+        const std::string MANIFEST_FILENAME = "manifest.json";
+        const std::string DATABASE_DIRECTORY = "DB";
+        const std::string BLOCKS_FILENAME = "blocks.dat";
+
+        /* Blocks read from the core at a time when exporting */
+        const uint32_t EXPORT_BATCH_SIZE = 1000;
+
+        /* Files are hashed a chunk at a time, and the chunk hashes hashed
+           together, so we never hold a whole file in memory */
+        const size_t CHECKSUM_CHUNK_SIZE = 4 * 1024 * 1024;
+
+        Crypto::Hash hashFile(const fs::path &path)
+        {
+            std::ifstream file(path.string(), std::ios::binary);
+
+            if (!file)
+            {
+                throw std::runtime_error("Failed to open snapshot file " + path.string());
+            }
+
+            std::vector<char> chunk(CHECKSUM_CHUNK_SIZE);
+            std::vector<Crypto::Hash> chunkHashes;
+
+            while (file)
+            {
+                file.read(chunk.data(), chunk.size());
+
+                if (file.gcount() > 0)
+                {
+                    chunkHashes.push_back(Crypto::cn_fast_hash(chunk.data(), static_cast<size_t>(file.gcount())));
+                }
+            }
+
+            if (file.bad())
+            {
+                throw std::runtime_error("Failed to read snapshot file " + path.string());
+            }
+
+            return Crypto::cn_fast_hash(chunkHashes.data(), chunkHashes.size() * sizeof(Crypto::Hash));
+        }
+
+        Crypto::Hash computeChecksum(const fs::path &root)
+        {
+            /* Sorted by name, as the order files are listed in isn't fixed */
+            std::vector<std::pair<std::string, fs::path>> files;
+
+            for (const auto &entry : fs::recursive_directory_iterator(root))
+            {
+                if (!fs::is_regular_file(entry.status()))
+                {
+                    continue;
+                }
+
+                /* Relative, so the name doesn't depend on how the directory
+                   was given, e.g. with or without a trailing slash */
+                std::string name = fs::relative(entry.path(), root).generic_string();
+
+                if (name == MANIFEST_FILENAME)
+                {
+                    continue;
+                }
+
+                files.emplace_back(std::move(name), entry.path());
+            }
+
+            std::sort(files.begin(), files.end());
+
+            std::string hashes;
+
+            for (const auto &[name, path] : files)
+            {
+                const Crypto::Hash fileHash = hashFile(path);
+
+                hashes += name;
+                hashes.append(reinterpret_cast<const char *>(&fileHash), sizeof(fileHash));
+            }
+
+            return Crypto::cn_fast_hash(hashes.data(), hashes.size());
+        }
+
+        /* Returns the hash of the block, checking it follows the block
+           with previousHash and isn't pruned */
+        Crypto::Hash getLinkedBlockHash(const RawBlock &rawBlock, const uint32_t index, const Crypto::Hash &previousHash)
+        {
+            BlockTemplate block;
+
+            if (!fromBinaryArray(block, rawBlock.block))
+            {
+                throw std::runtime_error("Failed to parse block " + std::to_string(index) + " of snapshot");
+            }
+
+            if (index > 0 && block.previousBlockHash != previousHash)
+            {
+                throw std::runtime_error("Block " + std::to_string(index) + " of snapshot doesn't follow the block before it");
+            }
+
+            /* A pruned block can't be imported into a database, and would
+               slip under the main chain storage's pruned height, which
+               clearing it resets */
+            if (rawBlock.transactions.size() != block.transactionHashes.size())
+            {
+                throw std::runtime_error("Block " + std::to_string(index) + " of snapshot is pruned");
+            }
+
+            return CachedBlock(block).getBlockHash();
+        }
+
+        void writeManifest(const fs::path &root, const SnapshotManifest &manifest)
+        {
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+            writer.StartObject();
+            {
+                writer.Key("version");
+                writer.Uint64(SNAPSHOT_VERSION);
+
+                writer.Key("blockCount");
+                writer.Uint(manifest.blockCount);
+
+                writer.Key("topHash");
+                writer.String(Common::podToHex(manifest.topHash));
+
+                writer.Key("checksum");
+                writer.String(Common::podToHex(manifest.checksum));
+            }
+            writer.EndObject();
+
+            std::ofstream file((root / MANIFEST_FILENAME).string());
+
+            file << buffer.GetString() << std::endl;
+
+            if (!file)
+            {
+                throw std::runtime_error("Failed to write snapshot manifest in " + root.string());
+            }
+        }
+
+        SnapshotManifest readManifest(const fs::path &root)
+        {
+            std::ifstream file((root / MANIFEST_FILENAME).string());
+
+            if (!file)
+            {
+                throw std::runtime_error("No snapshot manifest in " + root.string() + ", the snapshot may be incomplete");
+            }
+
+            const std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            rapidjson::Document j;
+
+            if (j.Parse(json.c_str()).HasParseError())
+            {
+                throw std::runtime_error("Snapshot manifest in " + root.string() + " is not valid JSON");
+            }
+
+            if (getUint64FromJSON(j, "version") != SNAPSHOT_VERSION)
+            {
+                throw std::runtime_error("Snapshot in " + root.string() + " is of an unsupported version");
+            }
+
+            SnapshotManifest manifest;
+
+            manifest.blockCount = static_cast<uint32_t>(getUint64FromJSON(j, "blockCount"));
+
+            if (!Common::podFromHex(getStringFromJSON(j, "topHash"), manifest.topHash)
+             || !Common::podFromHex(getStringFromJSON(j, "checksum"), manifest.checksum))
+            {
+                throw std::runtime_error("Snapshot manifest in " + root.string() + " has an invalid hash");
+            }
+
+            return manifest;
+        }
+
+        /* Hands each block of the snapshot, and its hash, to handler in
+           order, checking they form a chain. Returns the number of blocks. */
+        uint32_t forEachBlock(
+            const fs::path &root,
+            const std::function<void(uint32_t, RawBlock &&, const Crypto::Hash &)> &handler)
+        {
+            std::ifstream file((root / BLOCKS_FILENAME).string(), std::ios::binary);
+
+            if (!file)
+            {
+                throw std::runtime_error("No blocks file in snapshot " + root.string());
+            }
+
+            uint32_t index = 0;
+            Crypto::Hash hash = Constants::NULL_HASH;
+            std::string data;
+
+            uint32_t size;
+
+            while (file.read(reinterpret_cast<char *>(&size), sizeof(size)))
+            {
+                data.resize(size);
+
+                if (!file.read(&data[0], size))
+                {
+                    throw std::runtime_error("Blocks file of snapshot " + root.string() + " is truncated");
+                }
+
+                RawBlock rawBlock = deserializeRawBlock(data.data(), data.size());
+
+                hash = getLinkedBlockHash(rawBlock, index, hash);
+
+                handler(index, std::move(rawBlock), hash);
+
+                index++;
+            }
+
+            return index;
+        }
+    }
+
+    SnapshotManifest exportSnapshot(
+        const std::string &directory,
+        const ICore &core,
+        IDataBase &database)
+    {
+        const fs::path root(directory);
+
+        if (core.getPrunedHeight() > 0)
+        {
+            throw std::runtime_error("Can't export a snapshot of a pruned blockchain, the blocks below index "
+                                     + std::to_string(core.getPrunedHeight()) + " are missing their transactions");
+        }
+
+        if (fs::exists(root) && !fs::is_empty(root))
+        {
+            throw std::runtime_error("Snapshot directory " + directory + " is not empty");
+        }
+
+        std::error_code ec;
+        fs::create_directories(root, ec);
+
+        if (ec)
+        {
+            throw std::runtime_error("Failed to create snapshot directory " + directory + ": " + ec.message());
+        }
+
+        const auto error = database.createCheckpoint((root / DATABASE_DIRECTORY).string());
+
+        if (error)
+        {
+            throw std::runtime_error("Failed to create database checkpoint: " + error.message());
+        }
+
+        /* Taken after the checkpoint, so the main chain in the snapshot is
+           never behind its database. If it's ahead, the extra blocks are
+           imported on startup, just as after a crash. */
+        SnapshotManifest manifest;
+        manifest.blockCount = core.getTopBlockIndex() + 1;
+
+        std::ofstream file((root / BLOCKS_FILENAME).string(), std::ios::binary);
+
+        Crypto::Hash hash = Constants::NULL_HASH;
+
+        for (uint32_t startIndex = 0; startIndex < manifest.blockCount; startIndex += EXPORT_BATCH_SIZE)
+        {
+            const uint32_t count = std::min(EXPORT_BATCH_SIZE, manifest.blockCount - startIndex);
+
+            const std::vector<RawBlock> rawBlocks = core.getBlocks(startIndex, count);
+
+            /* The chain can shrink under us if we switch to an alternative
+               chain, and checking the blocks link up catches us reading
+               parts of two different chains */
+            if (rawBlocks.size() != count)
+            {
+                throw std::runtime_error("The main chain changed while it was being exported, try again");
+            }
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                hash = getLinkedBlockHash(rawBlocks[i], startIndex + i, hash);
+
+                const std::string data = serializeRawBlock(rawBlocks[i], false);
+                const uint32_t size = static_cast<uint32_t>(data.size());
+
+                file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+                file.write(data.data(), data.size());
+            }
+        }
+
+        file.close();
+
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write snapshot blocks in " + directory);
+        }
+
+        manifest.topHash = hash;
+        manifest.checksum = computeChecksum(root);
+
+        writeManifest(root, manifest);
+
+        return manifest;
+    }
+
+    SnapshotManifest loadSnapshot(
+        const std::string &directory,
+        const std::string &databaseDirectory,
+        IMainChainStorage &mainChainStorage,
+        const Checkpoints &checkpoints)
+    {
+        const fs::path root(directory);
+
+        const SnapshotManifest manifest = readManifest(root);
+
+        if (computeChecksum(root) != manifest.checksum)
+        {
+            throw std::runtime_error("Snapshot in " + directory + " does not match its checksum");
+        }
+
+        const Crypto::Hash genesisHash = CachedBlock(
+            fromBinaryArray<BlockTemplate>(mainChainStorage.getBlockByIndex(0).block)).getBlockHash();
+
+        Crypto::Hash topHash = Constants::NULL_HASH;
+
+        /* Everything is checked before we touch anything of ours */
+        const uint32_t blockCount = forEachBlock(root, [&](const uint32_t index, RawBlock &&, const Crypto::Hash &hash)
+        {
+            if (index == 0 && hash != genesisHash)
+            {
+                throw std::runtime_error("Snapshot in " + directory + " is of a different network");
+            }
+
+            if (!checkpoints.checkBlock(index, hash))
+            {
+                throw std::runtime_error("Block " + std::to_string(index) + " of snapshot doesn't match our checkpoint");
+            }
+
+            topHash = hash;
+        });
+
+        if (blockCount != manifest.blockCount || topHash != manifest.topHash)
+        {
+            throw std::runtime_error("Blocks of snapshot in " + directory + " don't match its manifest");
+        }
+
+        /* The old database goes first, so if we're interrupted, the daemon
+           rebuilds the database from whatever blocks we'd got to */
+        std::error_code ec;
+        fs::remove_all(databaseDirectory, ec);
+
+        if (ec)
+        {
+            throw std::runtime_error("Failed to remove database " + databaseDirectory + ": " + ec.message());
+        }
+
+        mainChainStorage.clear();
+
+        forEachBlock(root, [&mainChainStorage](const uint32_t, RawBlock &&rawBlock, const Crypto::Hash &)
+        {
+            mainChainStorage.pushBlock(rawBlock);
+        });
+
+        fs::copy(root / DATABASE_DIRECTORY, databaseDirectory, fs::copy_options::recursive, ec);
+
+        if (ec)
+        {
+            throw std::runtime_error("Failed to copy snapshot database to " + databaseDirectory + ": " + ec.message());
+        }
+
+        return manifest;
+    }
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "Checkpoints.h"
+#include "ICore.h"
+#include "IDataBase.h"
+#include "IMainChainStorage.h"
+
+#include <string>
+
+namespace CryptoNote
+{
+    /* Written alongside a snapshot once it's complete, a snapshot without
+       one was never finished */
+    struct SnapshotManifest
+    {
+        /* Blocks in the snapshot's main chain, the genesis block included */
+        uint32_t blockCount;
+
+        /* Hash of the last of those blocks */
+        Crypto::Hash topHash;
+
+        /* Covers the contents and names of every file in the snapshot, bar
+           the manifest itself */
+        Crypto::Hash checksum;
+    };
+
+    /* Writes a checkpoint of the database, and the main chain up to at
+       least the top block of that checkpoint, to directory, which must not
+       exist or be empty. Runs alongside the daemon syncing. Refuses to
+       export a pruned blockchain, a snapshot always has every block's
+       transactions. */
+    SnapshotManifest exportSnapshot(
+        const std::string &directory,
+        const ICore &core,
+        IDataBase &database);
+
+    /* Replaces the database in databaseDirectory, and the blocks in
+       mainChainStorage, with the snapshot in directory. Nothing is touched
+       unless the snapshot's checksum matches, its blocks form an unpruned
+       chain from our genesis block, and that chain passes every checkpoint.
+       The database mustn't be open.
+
+       The checksum only catches corruption, anyone can write a snapshot
+       with a matching one. When the core starts, the database's chain is
+       matched up with the snapshot's blocks and anything past where they
+       part is imported again, but the outputs and key images in the
+       database are taken as they are. Only load snapshots from a source you trust. */
+    SnapshotManifest loadSnapshot(
+        const std::string &directory,
+        const std::string &databaseDirectory,
+        IMainChainStorage &mainChainStorage,
+        const Checkpoints &checkpoints);
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <atomic>
+
+#include <condition_variable>
+
+#include <functional>
+
+#include <future>
+
+#include <memory>
+
+#include <mutex>
+
+#include <queue>
+
+#include <thread>
+
+#include <vector>
+
+/* A fixed size pool of worker threads. Jobs are pushed onto a queue and
+   picked up by the first free worker, and a future is handed back to the
+   caller so it can wait on the result. */
+class ThreadPool
+{
+    public:
+        /* A thread count of zero means use one thread per core */
+        ThreadPool(size_t threadCount) :
+            m_shouldStop(false)
+        {
+            if (threadCount == 0)
+            {
+                threadCount = std::thread::hardware_concurrency();
+            }
+
+            /* hardware_concurrency() is allowed to return 0 */
+            if (threadCount == 0)
+            {
+                threadCount = 1;
+            }
+
+            for (size_t i = 0; i < threadCount; i++)
+            {
+                m_threads.push_back(std::thread(&ThreadPool::workerLoop, this));
+            }
+        }
+
+        ~ThreadPool()
+        {
+            /* Aquire the lock, so no worker misses the wake up */
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_shouldStop = true;
+
+            lock.unlock();
+
+            /* Wake up all the workers so they can exit */
+            m_haveJob.notify_all();
+
+            for (auto &thread : m_threads)
+            {
+                if (thread.joinable())
+                {
+                    thread.join();
+                }
+            }
+        }
+
+        /* Not copyable or movable - the workers hold a pointer to us */
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool & operator=(const ThreadPool &) = delete;
+
+        /* Queue a job, and return a future which will hold its result, or the
+           exception it threw */
+        template <typename Function>
+        auto addJob(Function job) -> std::future<decltype(job())>
+        {
+            using Result = decltype(job());
+
+            /* std::function must be copyable, packaged_task isn't */
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::move(job));
+
+            std::future<Result> result = task->get_future();
+
+            /* Aquire the lock */
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_jobs.push([task]() { (*task)(); });
+
+            /* Unlock the mutex before notifying, so it doesn't block after
+               waking up */
+            lock.unlock();
+
+            m_haveJob.notify_one();
+
+            return result;
+        }
+
+        size_t threadCount() const
+        {
+            return m_threads.size();
+        }
+
+    private:
+        void workerLoop()
+        {
+            while (true)
+            {
+                std::function<void()> job;
+
+                {
+                    /* Aquire the lock */
+                    std::unique_lock<std::mutex> lock(m_mutex);
+
+                    /* Wait for a job to arrive, or for us to be told to stop.
+                       Any jobs still queued are finished before we exit, so
+                       no caller is left waiting on a broken future. */
+                    m_haveJob.wait(lock, [&]
+                    {
+                        return m_shouldStop || !m_jobs.empty();
+                    });
+
+                    if (m_jobs.empty())
+                    {
+                        return;
+                    }
+
+                    job = std::move(m_jobs.front());
+
+                    m_jobs.pop();
+                }
+
+                job();
+            }
+        }
+
+        /* The worker threads */
+        std::vector<std::thread> m_threads;
+
+        /* Jobs waiting for a free worker */
+        std::queue<std::function<void()>> m_jobs;
+
+        /* The mutex, to ensure we have atomic access to the job queue */
+        std::mutex m_mutex;
+
+        /* Triggered when a job is queued, or we are stopping */
+        std::condition_variable m_haveJob;
+
+        /* Whether we're stopping */
+        std::atomic<bool> m_shouldStop;
+};
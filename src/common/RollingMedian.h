@@ -0,0 +1,100 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cassert>
+#include <deque>
+#include <iterator>
+#include <set>
+
+namespace Common {
+
+/* Keeps the last `capacity` values pushed, along with their median. The
+   window is split into a lower and an upper half, so adding a value and
+   evicting the oldest one is O(log n), instead of sorting the whole window
+   every time the median is needed. The median is the same value
+   medianValue() would return for the window. */
+template <class T>
+class RollingMedian {
+public:
+  explicit RollingMedian(size_t capacity) : capacity(capacity) {
+    assert(capacity > 0);
+  }
+
+  void push(T value) {
+    values.push_back(value);
+    insertSorted(value);
+
+    if (values.size() > capacity) {
+      eraseSorted(values.front());
+      values.pop_front();
+    }
+
+    rebalance();
+  }
+
+  void clear() {
+    values.clear();
+    lower.clear();
+    upper.clear();
+  }
+
+  size_t size() const {
+    return values.size();
+  }
+
+  size_t getCapacity() const {
+    return capacity;
+  }
+
+  T median() const {
+    if (values.empty()) {
+      return T();
+    }
+
+    if (values.size() % 2) {
+      return *lower.rbegin();
+    }
+
+    return (*lower.rbegin() + *upper.begin()) / 2;
+  }
+
+private:
+  void insertSorted(T value) {
+    if (lower.empty() || value <= *lower.rbegin()) {
+      lower.insert(value);
+    } else {
+      upper.insert(value);
+    }
+  }
+
+  void eraseSorted(T value) {
+    if (!lower.empty() && value <= *lower.rbegin()) {
+      lower.erase(lower.find(value));
+    } else {
+      upper.erase(upper.find(value));
+    }
+  }
+
+  /* The lower half holds the extra element when the window size is odd */
+  void rebalance() {
+    while (lower.size() > upper.size() + 1) {
+      upper.insert(*lower.rbegin());
+      lower.erase(std::prev(lower.end()));
+    }
+
+    while (upper.size() > lower.size()) {
+      lower.insert(*upper.begin());
+      upper.erase(upper.begin());
+    }
+  }
+
+  size_t capacity;
+  std::deque<T> values;
+  std::multiset<T> lower;
+  std::multiset<T> upper;
+};
+
+}
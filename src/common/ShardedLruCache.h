@@ -0,0 +1,141 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Common {
+
+/* A least recently used cache, split into independently locked shards so
+   concurrent lookups of different keys rarely contend. Each shard evicts
+   its own least recently used entry once it holds its share of maxSize.
+   A maxSize of zero disables the cache. */
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+  explicit ShardedLruCache(size_t maxSize, size_t shardCount = 16) :
+    maxShardSize(maxSize == 0 ? 0 : std::max<size_t>(1, maxSize / shardCount)),
+    shards(shardCount),
+    hits(0),
+    misses(0) {
+  }
+
+  ShardedLruCache(const ShardedLruCache&) = delete;
+  ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+  bool get(const Key& key, Value& value) {
+    if (maxShardSize == 0) {
+      return false;
+    }
+
+    Shard& shard = getShard(key);
+    std::scoped_lock lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      ++misses;
+      return false;
+    }
+
+    /* Move to the front, it's now the most recently used */
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    value = it->second->second;
+
+    ++hits;
+    return true;
+  }
+
+  void insert(const Key& key, const Value& value) {
+    if (maxShardSize == 0) {
+      return;
+    }
+
+    Shard& shard = getShard(key);
+    std::scoped_lock lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      it->second->second = value;
+      shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+      return;
+    }
+
+    shard.entries.emplace_front(key, value);
+    shard.index.emplace(key, shard.entries.begin());
+
+    if (shard.entries.size() > maxShardSize) {
+      shard.index.erase(shard.entries.back().first);
+      shard.entries.pop_back();
+    }
+  }
+
+  void erase(const Key& key) {
+    if (maxShardSize == 0) {
+      return;
+    }
+
+    Shard& shard = getShard(key);
+    std::scoped_lock lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      shard.entries.erase(it->second);
+      shard.index.erase(it);
+    }
+  }
+
+  size_t size() const {
+    size_t result = 0;
+
+    for (auto& shard : shards) {
+      std::scoped_lock lock(shard.mutex);
+      result += shard.entries.size();
+    }
+
+    return result;
+  }
+
+  size_t getMaxSize() const {
+    return maxShardSize * shards.size();
+  }
+
+  uint64_t getHits() const {
+    return hits;
+  }
+
+  uint64_t getMisses() const {
+    return misses;
+  }
+
+private:
+  struct Shard {
+    mutable std::mutex mutex;
+    std::list<std::pair<Key, Value>> entries;
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index;
+  };
+
+  Shard& getShard(const Key& key) {
+    /* Mix the hash, so the shard isn't picked by the same low bits the
+       shard's own hash table uses for its buckets */
+    const size_t hash = Hash()(key);
+    return shards[(hash ^ (hash >> 17) ^ (hash >> 31)) % shards.size()];
+  }
+
+  const size_t maxShardSize;
+
+  std::vector<Shard> shards;
+
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+};
+
+}
@@ -255,6 +255,21 @@ const uint64_t DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE         = 256;
 const uint64_t DATABASE_READ_BUFFER_MB_DEFAULT_SIZE          = 10;
 const uint32_t DATABASE_DEFAULT_MAX_OPEN_FILES               = 100;
 const uint16_t DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT     = 2;
+const uint32_t DATABASE_GROUP_COMMIT_DEFAULT_BLOCKS          = 0;             // 0 = commit every block on its own
+const uint64_t DATABASE_GROUP_COMMIT_MAX_SIZE                = 64 * 1024 * 1024; // bytes
+const uint32_t DATABASE_GROUP_COMMIT_MAX_AGE                 = 5000;          // 5 seconds
+const uint32_t DATABASE_PRUNE_DEFAULT_DEPTH                  = 0;             // 0 = keep every block whole
+const uint32_t DATABASE_PRUNE_MIN_DEPTH                      = 10000;         // blocks, no deeper reorg is possible on a pruned node
+const uint32_t DATABASE_PRUNE_INTERVAL                       = 100;           // blocks, pruned together once this many are due
+const uint32_t DATABASE_PRUNE_BATCH_SIZE                     = 1000;          // blocks pruned per write
+
+const uint32_t VALIDATION_DEFAULT_THREADS_COUNT              = 0;             // 0 = one thread per core
+const size_t   VALIDATION_SIGNATURE_CACHE_SIZE               = 100000;        // verified ring signatures
+const size_t   VALIDATION_POINT_CACHE_DEFAULT_SIZE           = 50000;         // decompressed ring members, ~400 bytes each
+const size_t   VALIDATION_PRECALCULATE_MAX_BLOCKS            = BLOCKS_SYNCHRONIZING_DEFAULT_COUNT; // proof of work hashed ahead per batch
+
+const size_t   KEY_OUTPUT_CACHE_DEFAULT_SIZE                 = 200000;        // ring member outputs
+const size_t   SPENT_KEY_IMAGES_FILTER_MIN_CAPACITY          = 1000000;       // key images, the filter is rebuilt larger when outgrown
 
 const char     LATEST_VERSION_URL[]                          = "https://github.com/spawncoin/spawncoin/releases/latest";
 const std::string LICENSE_URL                                = "https://github.com/spawncoin/spawncoin/blob/master/LICENSE";
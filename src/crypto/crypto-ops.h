@@ -102,6 +102,7 @@ void sc_reduce(unsigned char *);
 
 void ge_scalarmult(ge_p2 *, const unsigned char *, const ge_p3 *);
 void ge_double_scalarmult_precomp_vartime(ge_p2 *, const unsigned char *, const ge_p3 *, const unsigned char *, const ge_dsmp);
+void ge_ring_double_scalarmult_vartime(ge_p2 *, ge_p2 *, const unsigned char *, const unsigned char *, const ge_dsmp, const ge_dsmp, const ge_dsmp);
 int ge_check_subgroup_precomp_vartime(const ge_dsmp);
 void ge_mul8(ge_p1p1 *, const ge_p2 *);
 extern const fe fe_ma2;
@@ -118,3 +119,15 @@ void sc_sub(unsigned char *, const unsigned char *, const unsigned char *);
 void sc_mulsub(unsigned char *, const unsigned char *, const unsigned char *, const unsigned char *);
 int sc_check(const unsigned char *);
 int sc_isnonzero(const unsigned char *); /* Doesn't normalize */
+
+/* Field arithmetic backends. The scalar multiplications above run on
+   whichever is set, with the same results. The 64-bit one needs a compiler
+   with __int128. ge_set_backend() returns -1 if the backend isn't
+   available, and isn't thread safe, so is for use at startup. */
+
+#define GE_BACKEND_REF10 0
+#define GE_BACKEND_64 1
+
+int ge_backend_available(int);
+int ge_set_backend(int);
+int ge_get_backend(void);
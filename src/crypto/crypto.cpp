@@ -5,6 +5,7 @@
 // 
 // Please see the included LICENSE file for more information.
 
+#include <algorithm>
 #include <alloca.h>
 #include <cassert>
 #include <cstddef>
@@ -12,7 +13,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 
+#include "Common/ShardedLruCache.h"
 #include "Common/Varint.h"
 #include "crypto.h"
 #include "hash.h"
@@ -25,6 +28,22 @@ namespace Crypto {
 #include "crypto-ops.h"
   }
 
+  static int toGeBackend(const FieldBackend backend) {
+    return backend == FieldBackend::Radix51 ? GE_BACKEND_64 : GE_BACKEND_REF10;
+  }
+
+  bool crypto_ops::setFieldBackend(const FieldBackend backend) {
+    return ge_set_backend(toGeBackend(backend)) == 0;
+  }
+
+  FieldBackend crypto_ops::getFieldBackend() {
+    return ge_get_backend() == GE_BACKEND_64 ? FieldBackend::Radix51 : FieldBackend::Ref10;
+  }
+
+  bool crypto_ops::isFieldBackendAvailable(const FieldBackend backend) {
+    return ge_backend_available(toGeBackend(backend)) != 0;
+  }
+
   static inline void random_scalar(EllipticCurveScalar &res) {
     unsigned char tmp[64];
     Random::randomBytes(64, tmp);
@@ -307,6 +326,54 @@ namespace Crypto {
     ge_p1p1_to_p3(&res, &point2);
   }
 
+  /* A ring member and its hash to a point, as used to check a ring
+     signature */
+  struct DecompressedKey {
+    ge_p3 key;
+    ge_p3 hashedKey;
+  };
+
+  using PointCache = Common::ShardedLruCache<PublicKey, DecompressedKey>;
+
+  /* Swapped out whole when resized, so threads mid-check keep the one they
+     started with */
+  static std::shared_ptr<PointCache> pointCache;
+
+  void crypto_ops::setPointCacheSize(const size_t maxSize) {
+    std::atomic_store(&pointCache, maxSize == 0 ? nullptr : std::make_shared<PointCache>(maxSize));
+  }
+
+  PointCacheStatistics crypto_ops::getPointCacheStatistics() {
+    const std::shared_ptr<PointCache> cache = std::atomic_load(&pointCache);
+
+    if (!cache)
+    {
+      return {0, 0, 0, 0};
+    }
+
+    return {cache->getHits(), cache->getMisses(), cache->size(), cache->getMaxSize()};
+  }
+
+  /* Decompresses the key, and hashes it to a point, going through the cache
+     if there is one. Returns false if the key isn't a valid point. */
+  static bool decompressKey(const std::shared_ptr<PointCache> &cache, const PublicKey &key, DecompressedKey &result) {
+    if (cache && cache->get(key, result)) {
+      return true;
+    }
+
+    if (ge_frombytes_vartime(&result.key, reinterpret_cast<const unsigned char*>(&key)) != 0) {
+      return false;
+    }
+
+    hash_to_ec(key, result.hashedKey);
+
+    if (cache) {
+      cache->insert(key, result);
+    }
+
+    return true;
+  }
+
   KeyImage crypto_ops::scalarmultKey(const KeyImage & P, const KeyImage & a) {
     ge_p3 A;
     ge_p2 R;
@@ -330,11 +397,15 @@ namespace Crypto {
   }
   
   void crypto_ops::generate_key_image(const PublicKey &pub, const SecretKey &sec, KeyImage &image) {
-    ge_p3 point;
     ge_p2 point2;
+    DecompressedKey cached;
     assert(sc_check(reinterpret_cast<const unsigned char*>(&sec)) == 0);
-    hash_to_ec(pub, point);
-    ge_scalarmult(&point2, reinterpret_cast<const unsigned char*>(&sec), &point);
+    /* Looked up but not filled, the keys we make images of are seldom seen again */
+    const std::shared_ptr<PointCache> cache = std::atomic_load(&pointCache);
+    if (!cache || !cache->get(pub, cached)) {
+      hash_to_ec(pub, cached.hashedKey);
+    }
+    ge_scalarmult(&point2, reinterpret_cast<const unsigned char*>(&sec), &cached.hashedKey);
     ge_tobytes(reinterpret_cast<unsigned char*>(&image), &point2);
   }
   
@@ -456,83 +527,173 @@ namespace Crypto {
         const std::vector<PublicKey> pubs,
         const std::vector<Signature> signatures) {
 
-        ge_p3 image_unp;
+        const RingCheck check {&prefix_hash, &image, &pubs, &signatures};
 
-        ge_dsmp image_pre;
+        return checkRingSignatures({&check, 1})[0];
+    }
 
-        EllipticCurveScalar sum, h;
+    /* The precomputed points of a key image or ring member. ge_dsmp is an
+       array, so it's wrapped to be stored in a vector. */
+    struct PrecomputedImage {
+        ge_dsmp image;
+    };
 
-        rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs.size())));
+    struct PrecomputedMember {
+        bool valid;
+        ge_dsmp key;
+        ge_dsmp hashedKey;
+    };
 
-        if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char*>(&image)) != 0)
-        {
-            return false;
-        }
+    std::vector<bool> crypto_ops::checkRingSignatures(
+        const Common::ArrayView<RingCheck> checks) {
 
-        ge_dsm_precomp(image_pre, &image_unp);
+        std::vector<bool> results(checks.getSize(), false);
 
-        if (ge_check_subgroup_precomp_vartime(image_pre) != 0)
+        std::vector<PrecomputedImage> images(checks.getSize());
+
+        /* The key images and scalars are checked first, so we don't bother
+           with the ring members of inputs which have already failed */
+        for (size_t i = 0; i < checks.getSize(); i++)
         {
-            return false;
+            const RingCheck &check = checks[i];
+
+            if (check.signatures->size() < check.publicKeys->size())
+            {
+                continue;
+            }
+
+            ge_p3 image_unp;
+
+            if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char*>(check.keyImage)) != 0)
+            {
+                continue;
+            }
+
+            ge_dsm_precomp(images[i].image, &image_unp);
+
+            if (ge_check_subgroup_precomp_vartime(images[i].image) != 0)
+            {
+                continue;
+            }
+
+            results[i] = std::all_of(check.signatures->begin(), check.signatures->begin() + check.publicKeys->size(),
+                [](const Signature &signature)
+            {
+                return sc_check(reinterpret_cast<const unsigned char*>(&signature)) == 0
+                    && sc_check(reinterpret_cast<const unsigned char*>(&signature) + 32) == 0;
+            });
         }
 
-        sc_0(reinterpret_cast<unsigned char*>(&sum));
+        /* Outputs are often in the rings of several inputs, so each distinct
+           ring member is decompressed, hashed and precomputed just once */
+        std::vector<PrecomputedMember> members;
+        std::unordered_map<PublicKey, size_t> memberIndexes;
 
-        buf->h = prefix_hash;
+        const std::shared_ptr<PointCache> cache = std::atomic_load(&pointCache);
 
-        for (size_t i = 0; i < pubs.size(); i++)
+        for (size_t i = 0; i < checks.getSize(); i++)
         {
-            ge_p2 tmp2;
-            ge_p3 tmp3;
+            if (!results[i])
+            {
+                continue;
+            }
 
-            if (sc_check(reinterpret_cast<const unsigned char*>(&signatures[i])) != 0 
-             || sc_check(reinterpret_cast<const unsigned char*>(&signatures[i]) + 32) != 0)
+            for (const auto &key : *checks[i].publicKeys)
             {
-                return false;
+                if (!memberIndexes.emplace(key, members.size()).second)
+                {
+                    continue;
+                }
+
+                members.emplace_back();
+
+                PrecomputedMember &member = members.back();
+
+                DecompressedKey points;
+
+                member.valid = decompressKey(cache, key, points);
+
+                if (member.valid)
+                {
+                    ge_dsm_precomp(member.key, &points.key);
+                    ge_dsm_precomp(member.hashedKey, &points.hashedKey);
+                }
             }
+        }
+
+        std::vector<unsigned char> comm;
 
-            if (ge_frombytes_vartime(&tmp3, reinterpret_cast<const unsigned char*>(&pubs[i])) != 0)
+        for (size_t i = 0; i < checks.getSize(); i++)
+        {
+            if (!results[i])
             {
-                return false;
+                continue;
             }
 
-            ge_double_scalarmult_base_vartime(
-                &tmp2,
-                reinterpret_cast<const unsigned char*>(&signatures[i]),
-                &tmp3,
-                reinterpret_cast<const unsigned char*>(&signatures[i]) + 32
-            );
+            const RingCheck &check = checks[i];
 
-            ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].a), &tmp2);
+            const std::vector<PublicKey> &pubs = *check.publicKeys;
+            const std::vector<Signature> &signatures = *check.signatures;
 
-            hash_to_ec(pubs[i], tmp3);
+            comm.resize(rs_comm_size(pubs.size()));
 
-            ge_double_scalarmult_precomp_vartime(
-                &tmp2,
-                reinterpret_cast<const unsigned char*>(&signatures[i]) + 32,
-                &tmp3,
-                reinterpret_cast<const unsigned char*>(&signatures[i]),
-                image_pre
-            );
+            rs_comm *const buf = reinterpret_cast<rs_comm *>(comm.data());
 
-            ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].b), &tmp2);
+            EllipticCurveScalar sum, h;
 
-            sc_add(
-                reinterpret_cast<unsigned char*>(&sum),
-                reinterpret_cast<unsigned char*>(&sum),
-                reinterpret_cast<const unsigned char*>(&signatures[i])
-            );
-        }
+            sc_0(reinterpret_cast<unsigned char*>(&sum));
 
-        hash_to_scalar(buf, rs_comm_size(pubs.size()), h);
+            buf->h = *check.prefixHash;
 
-        sc_sub(
-            reinterpret_cast<unsigned char*>(&h),
-            reinterpret_cast<unsigned char*>(&h),
-            reinterpret_cast<unsigned char*>(&sum)
-        );
+            for (size_t j = 0; j < pubs.size(); j++)
+            {
+                const PrecomputedMember &member = members[memberIndexes[pubs[j]]];
+
+                if (!member.valid)
+                {
+                    results[i] = false;
+                    break;
+                }
+
+                ge_p2 a, b;
+
+                ge_ring_double_scalarmult_vartime(
+                    &a,
+                    &b,
+                    reinterpret_cast<const unsigned char*>(&signatures[j]),
+                    reinterpret_cast<const unsigned char*>(&signatures[j]) + 32,
+                    member.key,
+                    member.hashedKey,
+                    images[i].image
+                );
+
+                ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[j].a), &a);
+                ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[j].b), &b);
+
+                sc_add(
+                    reinterpret_cast<unsigned char*>(&sum),
+                    reinterpret_cast<unsigned char*>(&sum),
+                    reinterpret_cast<const unsigned char*>(&signatures[j])
+                );
+            }
+
+            if (!results[i])
+            {
+                continue;
+            }
+
+            hash_to_scalar(buf, rs_comm_size(pubs.size()), h);
+
+            sc_sub(
+                reinterpret_cast<unsigned char*>(&h),
+                reinterpret_cast<unsigned char*>(&h),
+                reinterpret_cast<unsigned char*>(&sum)
+            );
+
+            results[i] = sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) == 0;
+        }
 
-        return sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) == 0;
+        return results;
     }
 
     void crypto_ops::generateViewFromSpend(
@@ -15,6 +15,8 @@
 
 #include <CryptoTypes.h>
 
+#include <Common/ArrayView.h>
+
 #include "hash.h"
 
 namespace Crypto {
@@ -27,6 +29,31 @@ struct EllipticCurveScalar {
   uint8_t data[32];
 };
 
+/* The field arithmetic the elliptic curve operations run on. Ref10 uses
+   10 limbs of 25.5 bits and runs anywhere, Radix51 uses 5 limbs of 51 bits
+   and needs 128 bit multiplication. Both give the same results. */
+enum class FieldBackend {
+  Ref10,
+  Radix51
+};
+
+/* How well the cache of decompressed ring members is doing */
+struct PointCacheStatistics {
+  uint64_t hits;
+  uint64_t misses;
+  size_t size;
+  size_t maxSize;
+};
+
+/* One input's ring signature, for crypto_ops::checkRingSignatures(). The
+   pointed to values must outlive the check. */
+struct RingCheck {
+  const Hash *prefixHash;
+  const KeyImage *keyImage;
+  const std::vector<PublicKey> *publicKeys;
+  const std::vector<Signature> *signatures;
+};
+
   class crypto_ops {
     crypto_ops();
     crypto_ops(const crypto_ops &);
@@ -87,6 +114,31 @@ struct EllipticCurveScalar {
             const std::vector<PublicKey> pubs,
             const std::vector<Signature> signatures);
 
+        /* Checks the ring signatures of several inputs together, which is
+           quicker than checking them one at a time, since each distinct
+           ring member is only decompressed once. Returns whether each
+           input's signatures are valid, in the same order. */
+        static std::vector<bool> checkRingSignatures(
+            const Common::ArrayView<RingCheck> checks);
+
+        /* Keeps up to maxSize ring members decompressed in memory, shared
+           by every thread, so outputs used over and over as decoys aren't
+           decompressed and hashed to a point every time. Off until this is
+           called, and a maxSize of zero turns it off again. */
+        static void setPointCacheSize(const size_t maxSize);
+
+        static PointCacheStatistics getPointCacheStatistics();
+
+        /* Ref10 is the default. Radix51 is opt in, and must be picked
+           before any other thread is using the curve operations, as
+           switching isn't thread safe. Returns false if the backend isn't
+           available. */
+        static bool setFieldBackend(const FieldBackend backend);
+
+        static FieldBackend getFieldBackend();
+
+        static bool isFieldBackendAvailable(const FieldBackend backend);
+
         static void generateViewFromSpend(
             const Crypto::SecretKey &spend,
             Crypto::SecretKey &viewSecret);
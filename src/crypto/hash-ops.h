@@ -60,11 +60,32 @@ enum {
   HASH_SIZE = 32,
   HASH_DATA_AREA = 136,
   SLOW_HASH_CONTEXT_SIZE = 2097552,
-  SLOW_HASH_CONTEXT_LITE_SIZE = 1048976  // Suml: Unused for now but this is the right size for 1MB scratchpads.
+  SLOW_HASH_CONTEXT_LITE_SIZE = 1048976,  // Suml: Unused for now but this is the right size for 1MB scratchpads.
+  SLOW_HASH_MAX_WAYS = 4
 };
 
 void cn_fast_hash(const void *data, size_t length, char *hash);
 void cn_slow_hash(const void *data, size_t length, char *hash, int light, int variant, int prehashed, uint32_t page_size, uint32_t scratchpad, uint32_t iterations);
+/* Gives the same hashes as calling cn_slow_hash on each of the count inputs,
+   but interleaves up to SLOW_HASH_MAX_WAYS of them on this thread where it
+   can, which is quicker per hash */
+void cn_slow_hash_multi(const void *const *data, const size_t *length, char *const *hash, size_t count, int light, int variant, int prehashed, uint32_t page_size, uint32_t scratchpad, uint32_t iterations);
+
+/* How the slow hash scratchpad of a thread is allocated, best last. Each
+   thread keeps its scratchpad until it exits. */
+enum {
+  SLOW_HASH_SCRATCHPAD_NONE = 0,                // Not allocated yet
+  SLOW_HASH_SCRATCHPAD_PLAIN,                   // Normal pages
+  SLOW_HASH_SCRATCHPAD_TRANSPARENT_HUGE_PAGES,  // Normal pages, asking the kernel to use huge pages
+  SLOW_HASH_SCRATCHPAD_HUGE_PAGES               // Reserved huge pages
+};
+
+/* Sets the best mode scratchpads are allocated with from now on, and frees
+   the scratchpad of this thread, so its next hash uses it. Other threads
+   can be hashing meanwhile, they pick it up when they next allocate. */
+void slow_hash_set_scratchpad_mode(int mode);
+/* How the scratchpad of this thread was allocated */
+int slow_hash_get_scratchpad_mode(void);
 
 void hash_extra_blake(const void *data, size_t length, char *hash);
 void hash_extra_groestl(const void *data, size_t length, char *hash);
@@ -142,6 +142,10 @@ namespace Crypto {
     cn_slow_hash(data, length, reinterpret_cast<char *>(&hash), 1, 2, 0, CN_TURTLE_PAGE_SIZE, CN_TURTLE_SCRATCHPAD, CN_TURTLE_ITERATIONS);
   }
 
+  inline void cn_turtle_lite_slow_hash_v2_multi(const void *const *data, const size_t *length, Hash *const *hashes, size_t count) {
+    cn_slow_hash_multi(data, length, reinterpret_cast<char *const *>(hashes), count, 1, 2, 0, CN_TURTLE_PAGE_SIZE, CN_TURTLE_SCRATCHPAD, CN_TURTLE_ITERATIONS);
+  }
+
   // CryptoNight Soft Shell
   inline  void cn_soft_shell_slow_hash_v0(const void *data, size_t length, Hash &hash, uint32_t height) {
     uint32_t base_offset = (height % CN_SOFT_SHELL_WINDOW);
@@ -188,6 +192,19 @@ namespace Crypto {
     cn_slow_hash(data, length, reinterpret_cast<char *>(&hash), 1, 2, 0, pagesize, scratchpad, iterations);
   }
 
+  inline const char *slow_hash_scratchpad_mode_name(int mode) {
+    switch (mode) {
+      case SLOW_HASH_SCRATCHPAD_HUGE_PAGES:
+        return "huge pages";
+      case SLOW_HASH_SCRATCHPAD_TRANSPARENT_HUGE_PAGES:
+        return "transparent huge pages";
+      case SLOW_HASH_SCRATCHPAD_PLAIN:
+        return "normal pages";
+      default:
+        return "not allocated";
+    }
+  }
+
   inline void tree_hash(const Hash *hashes, size_t count, Hash &root_hash) {
     tree_hash(reinterpret_cast<const char (*)[HASH_SIZE]>(hashes), count, reinterpret_cast<char *>(&root_hash));
   }
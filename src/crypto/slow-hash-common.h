@@ -43,11 +43,19 @@ extern int aesb_pseudo_round(const uint8_t *in, uint8_t *out, const uint8_t *exp
     xor64(p, tweak1_2); \
   } while(0)
 
+/* For errors the slow hash can't return, message must be a string literal */
+#define SLOW_HASH_ABORT(message) \
+  do \
+  { \
+    fprintf(stderr, "%s\n", message); \
+    fflush(stderr); \
+    abort(); \
+  } while(0)
+
 #define VARIANT1_CHECK() \
   do if (length < 43) \
   { \
-    fprintf(stderr, "Cryptonight variant 1 need at least 43 bytes of data"); \
-    abort(); \
+    SLOW_HASH_ABORT("Cryptonight variant 1 need at least 43 bytes of data"); \
   } while(0)
 
 #define NONCE_POINTER (((const uint8_t*)data)+35)
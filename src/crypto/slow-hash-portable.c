@@ -25,6 +25,17 @@ void slow_hash_free_state(void)
     return;
 }
 
+void slow_hash_set_scratchpad_mode(int mode)
+{
+    // The scratchpad is allocated on each hash here, so there's no choice of mode
+    (void) mode;
+}
+
+int slow_hash_get_scratchpad_mode(void)
+{
+    return SLOW_HASH_SCRATCHPAD_PLAIN;
+}
+
 static void (*const extra_hashes[4])(const void *, size_t, char *) =
 {
     hash_extra_blake, hash_extra_groestl, hash_extra_jh, hash_extra_skein
@@ -232,4 +243,16 @@ void cn_slow_hash(const void *data, size_t length, char *hash, int light, int va
   #endif
 }
 
+
+void cn_slow_hash_multi(const void *const *data, const size_t *length, char *const *hash, size_t count, int light, int variant, int prehashed, uint32_t page_size, uint32_t scratchpad, uint32_t iterations)
+{
+    size_t i;
+
+    // No interleaved version here yet, so these are just hashed one at a time
+    for(i = 0; i < count; i++)
+    {
+        cn_slow_hash(data[i], length[i], hash[i], light, variant, prehashed, page_size, scratchpad, iterations);
+    }
+}
+
 #endif
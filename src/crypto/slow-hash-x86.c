@@ -35,6 +35,7 @@
     #endif
   #else
     #include <wmmintrin.h>
+    #include <pthread.h>
     #include <sys/mman.h>
     #define STATIC static
     #define INLINE inline
@@ -123,7 +124,24 @@ union cn_slow_hash_state
   #pragma pack(pop)
 
 THREADV uint8_t *hp_state = NULL;
-THREADV int hp_allocated = 0;
+THREADV size_t hp_size = 0;
+THREADV int hp_mode = SLOW_HASH_SCRATCHPAD_NONE;
+
+/* The best scratchpad mode to try, see slow_hash_set_scratchpad_mode. Set
+   by one thread while others are allocating, so only accessed atomically. */
+  #if defined(_MSC_VER)
+static volatile long hp_max_mode = SLOW_HASH_SCRATCHPAD_HUGE_PAGES;
+
+    #define hp_max_mode_load() ((int) InterlockedCompareExchange(&hp_max_mode, 0, 0))
+    #define hp_max_mode_store(mode) InterlockedExchange(&hp_max_mode, (long) (mode))
+  #else
+static int hp_max_mode = SLOW_HASH_SCRATCHPAD_HUGE_PAGES;
+
+    #define hp_max_mode_load() __atomic_load_n(&hp_max_mode, __ATOMIC_ACQUIRE)
+    #define hp_max_mode_store(mode) __atomic_store_n(&hp_max_mode, (mode), __ATOMIC_RELEASE)
+  #endif
+
+  #define HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
   #if defined(_MSC_VER)
     #define cpuid(info,x)    __cpuidex(info,x,0)
@@ -409,76 +427,248 @@ BOOL SetLockPagesPrivilege(HANDLE hProcess, BOOL bEnable)
 }
   #endif
 
+void slow_hash_free_state(void);
+
+STATIC INLINE size_t round_up(size_t size, size_t multiple)
+{
+    return (size + multiple - 1) / multiple * multiple;
+}
+
 /**
- * @brief allocate the 2MB scratch buffer using OS support for huge pages, if available
- *
- * This function tries to allocate the 2MB scratch buffer using a single
- * 2MB "huge page" (instead of the usual 4KB page sizes) to reduce TLB misses
- * during the random accesses to the scratch buffer.  This is one of the
- * important speed optimizations needed to make CryptoNight faster.
+ * @brief maps a scratchpad of at least size bytes in the given mode
  *
- * No parameters.  Updates a thread-local pointer, hp_state, to point to
- * the allocated buffer.
+ * @return the scratchpad, or NULL if the mode isn't available. The size
+ * actually mapped is stored in mapped_size.
  */
 
-void slow_hash_allocate_state(uint32_t page_size)
+static uint8_t *slow_hash_map_state(size_t size, int mode, size_t *mapped_size)
 {
-    if(hp_state != NULL)
+    uint8_t *state = NULL;
+
+    switch(mode)
     {
-        return;
+        case SLOW_HASH_SCRATCHPAD_HUGE_PAGES:
+        {
+          #if defined(_MSC_VER) || defined(__MINGW32__)
+            const size_t large_page_size = GetLargePageMinimum();
+
+            if(large_page_size == 0 || !SetLockPagesPrivilege(GetCurrentProcess(), TRUE))
+            {
+                return NULL;
+            }
+
+            *mapped_size = round_up(size, large_page_size);
+            state = (uint8_t *) VirtualAlloc(NULL, *mapped_size, MEM_LARGE_PAGES | MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+          #elif defined(MAP_HUGETLB)
+            *mapped_size = round_up(size, HUGE_PAGE_SIZE);
+            state = mmap(0, *mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+            if(state == MAP_FAILED)
+            {
+                state = NULL;
+            }
+          #endif
+
+            return state;
+        }
+        case SLOW_HASH_SCRATCHPAD_TRANSPARENT_HUGE_PAGES:
+        {
+          #if !defined(_MSC_VER) && !defined(__MINGW32__) && defined(MADV_HUGEPAGE)
+            /* The kernel only backs 2MB aligned ranges with a huge page, so
+               we map an extra 2MB and trim it to an aligned range */
+            const size_t aligned_size = round_up(size, HUGE_PAGE_SIZE);
+            uint8_t *mapping = mmap(0, aligned_size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            size_t head;
+
+            if(mapping == MAP_FAILED)
+            {
+                return NULL;
+            }
+
+            head = round_up((uintptr_t) mapping, HUGE_PAGE_SIZE) - (uintptr_t) mapping;
+
+            if(head > 0)
+            {
+                munmap(mapping, head);
+            }
+
+            munmap(mapping + head + aligned_size, HUGE_PAGE_SIZE - head);
+
+            state = mapping + head;
+
+            if(madvise(state, aligned_size, MADV_HUGEPAGE) != 0)
+            {
+                munmap(state, aligned_size);
+                return NULL;
+            }
+
+            *mapped_size = aligned_size;
+          #endif
+
+            return state;
+        }
+        case SLOW_HASH_SCRATCHPAD_PLAIN:
+        {
+            *mapped_size = size;
+            return (uint8_t *) malloc(size);
+        }
+        default:
+        {
+            return NULL;
+        }
     }
+}
 
   #if defined(_MSC_VER) || defined(__MINGW32__)
-    SetLockPagesPrivilege(GetCurrentProcess(), TRUE);
-    hp_state = (uint8_t *) VirtualAlloc(hp_state, page_size, MEM_LARGE_PAGES | MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+static DWORD hp_fls_index = FLS_OUT_OF_INDEXES;
+static INIT_ONCE hp_fls_once = INIT_ONCE_STATIC_INIT;
+
+static VOID WINAPI slow_hash_thread_exit(PVOID data)
+{
+    (void) data;
+    slow_hash_free_state();
+}
+
+static BOOL CALLBACK slow_hash_create_fls(PINIT_ONCE once, PVOID parameter, PVOID *context)
+{
+    (void) once;
+    (void) parameter;
+    (void) context;
+
+    hp_fls_index = FlsAlloc(slow_hash_thread_exit);
+
+    return TRUE;
+}
+
+/* Frees the scratchpad when this thread exits */
+static void slow_hash_free_state_on_exit(void)
+{
+    InitOnceExecuteOnce(&hp_fls_once, slow_hash_create_fls, NULL, NULL);
+
+    if(hp_fls_index != FLS_OUT_OF_INDEXES)
+    {
+        FlsSetValue(hp_fls_index, hp_state);
+    }
+}
   #else
-    #if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__DragonFly__) || defined(__NetBSD__)
-    hp_state = mmap(0, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, 0, 0);
-    #else
-    hp_state = mmap(0, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, 0, 0);
-    #endif
+static pthread_key_t hp_key;
+static pthread_once_t hp_key_once = PTHREAD_ONCE_INIT;
+static int hp_key_created = 0;
 
-    if(hp_state == MAP_FAILED)
+static void slow_hash_thread_exit(void *data)
+{
+    (void) data;
+    slow_hash_free_state();
+}
+
+static void slow_hash_create_key(void)
+{
+    hp_key_created = pthread_key_create(&hp_key, slow_hash_thread_exit) == 0;
+}
+
+/* Frees the scratchpad when this thread exits */
+static void slow_hash_free_state_on_exit(void)
+{
+    pthread_once(&hp_key_once, slow_hash_create_key);
+
+    if(hp_key_created)
     {
-        hp_state = NULL;
+        pthread_setspecific(hp_key, hp_state);
     }
+}
   #endif
 
-    hp_allocated = 1;
+/**
+ * @brief allocate the scratch buffer using OS support for huge pages, if available
+ *
+ * The random accesses to the scratch buffer take a TLB miss on nearly every
+ * read with the usual 4KB pages, so this first tries to allocate it from
+ * reserved 2MB "huge pages", then asks for transparent huge pages, and only
+ * then falls back to a plain allocation. This is one of the important speed
+ * optimizations needed to make CryptoNight faster.
+ *
+ * Each thread keeps its scratch buffer, growing it when a bigger one is
+ * needed, until it exits. As the hashing thread is the first to write to
+ * it, the kernel places it on that thread's NUMA node.
+ *
+ * Updates a thread-local pointer, hp_state, to point to the allocated buffer.
+ */
+
+void slow_hash_allocate_state(size_t size)
+{
+    int mode;
+
+    if(hp_state != NULL && hp_size >= size)
+    {
+        return;
+    }
+
+    slow_hash_free_state();
+
+    for(mode = hp_max_mode_load(); mode > SLOW_HASH_SCRATCHPAD_NONE && hp_state == NULL; mode--)
+    {
+        hp_state = slow_hash_map_state(size, mode, &hp_size);
+        hp_mode = mode;
+    }
 
     if(hp_state == NULL)
     {
-        hp_allocated = 0;
-        hp_state = (uint8_t *) malloc(page_size);
+        SLOW_HASH_ABORT("Failed to allocate the slow hash scratchpad");
     }
+
+    slow_hash_free_state_on_exit();
 }
 
 /**
  *@brief frees the state allocated by slow_hash_allocate_state
  */
 
-void slow_hash_free_state(uint32_t page_size)
+void slow_hash_free_state(void)
 {
     if(hp_state == NULL)
     {
         return;
     }
 
-    if(!hp_allocated)
-    {
-        free(hp_state);
-    }
-    else
+    switch(hp_mode)
     {
-      #if defined(_MSC_VER) || defined(__MINGW32__)
-        VirtualFree(hp_state, 0, MEM_RELEASE);
-      #else
-        munmap(hp_state, page_size);
-      #endif
+        case SLOW_HASH_SCRATCHPAD_HUGE_PAGES:
+        {
+          #if defined(_MSC_VER) || defined(__MINGW32__)
+            VirtualFree(hp_state, 0, MEM_RELEASE);
+          #else
+            munmap(hp_state, hp_size);
+          #endif
+            break;
+        }
+        case SLOW_HASH_SCRATCHPAD_TRANSPARENT_HUGE_PAGES:
+        {
+          #if !defined(_MSC_VER) && !defined(__MINGW32__)
+            munmap(hp_state, hp_size);
+          #endif
+            break;
+        }
+        default:
+        {
+            free(hp_state);
+            break;
+        }
     }
 
     hp_state = NULL;
-    hp_allocated = 0;
+    hp_size = 0;
+    hp_mode = SLOW_HASH_SCRATCHPAD_NONE;
+}
+
+void slow_hash_set_scratchpad_mode(int mode)
+{
+    hp_max_mode_store(mode);
+    slow_hash_free_state();
+}
+
+int slow_hash_get_scratchpad_mode(void)
+{
+    return hp_mode;
 }
 
 /**
@@ -657,7 +847,195 @@ void cn_slow_hash(const void *data, size_t length, char *hash, int light, int va
     memcpy(state.init, text, INIT_SIZE_BYTE);
     hash_permutation(&state.hs);
     extra_hashes[state.hs.b[0] & 3](&state, 200, hash);
-    slow_hash_free_state(page_size);
+}
+
+
+/* The state of one of the hashes computed together by cn_slow_hash_multi */
+struct cn_slow_hash_lane
+{
+    union cn_slow_hash_state state;
+    RDATA_ALIGN16 uint8_t expandedKey[240];
+    uint8_t text[INIT_SIZE_BYTE];
+    RDATA_ALIGN16 uint64_t a[2];
+    RDATA_ALIGN16 uint64_t b[4];
+    RDATA_ALIGN16 uint64_t c[2];
+    __m128i _b, _b1;
+    uint64_t tweak1_2;
+    uint64_t division_result;
+    uint64_t sqrt_result;
+    uint8_t *hp_state;
+};
+
+/* CryptoNight steps 1 and 2 of cn_slow_hash, for one lane */
+STATIC INLINE void cn_slow_hash_lane_init(struct cn_slow_hash_lane *lane, const void *data, size_t length, int variant, int prehashed, uint32_t init_rounds)
+{
+    size_t i;
+
+    if (prehashed)
+    {
+        memcpy(&lane->state.hs, data, length);
+    }
+    else
+    {
+        hash_process(&lane->state.hs, data, length);
+    }
+
+    memcpy(lane->text, lane->state.init, INIT_SIZE_BYTE);
+
+    if (variant == 1)
+    {
+        VARIANT1_CHECK();
+    }
+
+    lane->tweak1_2 = (variant == 1) ? (lane->state.hs.w[24] ^ (*((const uint64_t*)NONCE_POINTER))) : 0;
+    lane->division_result = 0;
+    lane->sqrt_result = 0;
+    lane->b[2] = 0;
+    lane->b[3] = 0;
+
+    if (variant == 2)
+    {
+        lane->b[2] = lane->state.hs.w[8] ^ lane->state.hs.w[10];
+        lane->b[3] = lane->state.hs.w[9] ^ lane->state.hs.w[11];
+        lane->division_result = lane->state.hs.w[12];
+        lane->sqrt_result = lane->state.hs.w[13];
+    }
+
+    aes_expand_key(lane->state.hs.b, lane->expandedKey);
+
+    for(i = 0; i < init_rounds; i++)
+    {
+        aes_pseudo_round(lane->text, lane->text, lane->expandedKey, INIT_SIZE_BLK);
+        memcpy(&lane->hp_state[i * INIT_SIZE_BYTE], lane->text, INIT_SIZE_BYTE);
+    }
+
+    lane->a[0] = U64(&lane->state.k[0])[0] ^ U64(&lane->state.k[32])[0];
+    lane->a[1] = U64(&lane->state.k[0])[1] ^ U64(&lane->state.k[32])[1];
+    lane->b[0] = U64(&lane->state.k[16])[0] ^ U64(&lane->state.k[48])[0];
+    lane->b[1] = U64(&lane->state.k[16])[1] ^ U64(&lane->state.k[48])[1];
+
+    lane->_b = _mm_load_si128(R128(lane->b));
+    lane->_b1 = _mm_load_si128(R128(lane->b) + 1);
+}
+
+/* One iteration of CryptoNight step 3, for one lane. Nothing here depends
+   on the other lanes, so the CPU can overlap the scratchpad reads of one
+   lane with the AES and multiply of the next. */
+STATIC INLINE void cn_slow_hash_lane_round(struct cn_slow_hash_lane *lane, int variant, size_t lightFlag, uint32_t TOTALBLOCKS)
+{
+    uint8_t *hp_state = lane->hp_state;
+    uint64_t *a = lane->a;
+    uint64_t *b = lane->b;
+    uint64_t *c = lane->c;
+    const uint64_t tweak1_2 = lane->tweak1_2;
+    uint64_t division_result = lane->division_result;
+    uint64_t sqrt_result = lane->sqrt_result;
+    __m128i _a, _b = lane->_b, _b1 = lane->_b1, _c;
+    uint64_t hi, lo;
+    uint64_t *p;
+    size_t j;
+
+    pre_aes();
+    _c = _mm_aesenc_si128(_c, _a);
+    post_aes();
+
+    lane->_b = _b;
+    lane->_b1 = _b1;
+    lane->division_result = division_result;
+    lane->sqrt_result = sqrt_result;
+}
+
+/* CryptoNight steps 4 and 5 of cn_slow_hash, for one lane */
+STATIC INLINE void cn_slow_hash_lane_final(struct cn_slow_hash_lane *lane, char *hash, uint32_t init_rounds)
+{
+    size_t i;
+
+    static void (*const extra_hashes[4])(const void *, size_t, char *) =
+    {
+        hash_extra_blake, hash_extra_groestl, hash_extra_jh, hash_extra_skein
+    };
+
+    memcpy(lane->text, lane->state.init, INIT_SIZE_BYTE);
+    aes_expand_key(&lane->state.hs.b[32], lane->expandedKey);
+
+    for(i = 0; i < init_rounds; i++)
+    {
+        aes_pseudo_round_xor(lane->text, lane->text, lane->expandedKey, &lane->hp_state[i * INIT_SIZE_BYTE], INIT_SIZE_BLK);
+    }
+
+    memcpy(lane->state.init, lane->text, INIT_SIZE_BYTE);
+    hash_permutation(&lane->state.hs);
+    extra_hashes[lane->state.hs.b[0] & 3](&lane->state, 200, hash);
+}
+
+/**
+ * @brief computes up to SLOW_HASH_MAX_WAYS CryptoNight hashes on this thread at once
+ *
+ * A single hash spends most of its time waiting on scratchpad reads, as
+ * each one depends on the last. Hashes of different data don't depend on
+ * each other, so stepping through them together, each with its own
+ * scratchpad, keeps several reads in flight. Needs hardware AES.
+ */
+static void cn_slow_hash_ways(const void *const *data, const size_t *length, char *const *hash, size_t ways, int variant, int prehashed, uint32_t page_size, uint32_t scratchpad, uint32_t iterations, size_t lightFlag)
+{
+    uint32_t TOTALBLOCKS = (page_size / AES_BLOCK_SIZE);
+    uint32_t init_rounds = (scratchpad / INIT_SIZE_BYTE);
+    uint32_t aes_rounds = (iterations / 2);
+
+    struct cn_slow_hash_lane lanes[SLOW_HASH_MAX_WAYS];
+    size_t i, l;
+
+    slow_hash_allocate_state(page_size * ways);
+
+    for(l = 0; l < ways; l++)
+    {
+        lanes[l].hp_state = &hp_state[l * page_size];
+        cn_slow_hash_lane_init(&lanes[l], data[l], length[l], variant, prehashed, init_rounds);
+    }
+
+    for(i = 0; i < aes_rounds; i++)
+    {
+        for(l = 0; l < ways; l++)
+        {
+            cn_slow_hash_lane_round(&lanes[l], variant, lightFlag, TOTALBLOCKS);
+        }
+    }
+
+    for(l = 0; l < ways; l++)
+    {
+        cn_slow_hash_lane_final(&lanes[l], hash[l], init_rounds);
+    }
+}
+
+void cn_slow_hash_multi(const void *const *data, const size_t *length, char *const *hash, size_t count, int light, int variant, int prehashed, uint32_t page_size, uint32_t scratchpad, uint32_t iterations)
+{
+    size_t lightFlag = (light ? 2: 1);
+    size_t i;
+
+    /* Interleaving buys nothing with software AES, it's bound by the AES */
+    if(force_software_aes() || !check_aes_hw())
+    {
+        for(i = 0; i < count; i++)
+        {
+            cn_slow_hash(data[i], length[i], hash[i], light, variant, prehashed, page_size, scratchpad, iterations);
+        }
+
+        return;
+    }
+
+    for(i = 0; i < count; i += SLOW_HASH_MAX_WAYS)
+    {
+        const size_t ways = (count - i < SLOW_HASH_MAX_WAYS) ? count - i : SLOW_HASH_MAX_WAYS;
+
+        if(ways == 1)
+        {
+            cn_slow_hash(data[i], length[i], hash[i], light, variant, prehashed, page_size, scratchpad, iterations);
+        }
+        else
+        {
+            cn_slow_hash_ways(&data[i], &length[i], &hash[i], ways, variant, prehashed, page_size, scratchpad, iterations, lightFlag);
+        }
+    }
 }
 
 #endif
@@ -0,0 +1,74 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BlockTimestampIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace CryptoNote {
+
+void BlockTimestampIndex::push(uint64_t timestamp) {
+  const auto index = static_cast<uint32_t>(maxTimestamps.size());
+
+  maxTimestamps.push_back(maxTimestamps.empty() ? timestamp : std::max(maxTimestamps.back(), timestamp));
+
+  /* Usually the newest timestamp, and otherwise close to it, so this only
+     moves a few entries */
+  const auto entry = std::make_pair(timestamp, index);
+  sortedTimestamps.insert(std::upper_bound(sortedTimestamps.begin(), sortedTimestamps.end(), entry), entry);
+}
+
+void BlockTimestampIndex::pop(uint64_t timestamp) {
+  assert(!maxTimestamps.empty());
+
+  const auto index = static_cast<uint32_t>(maxTimestamps.size() - 1);
+
+  const auto it = std::lower_bound(sortedTimestamps.begin(), sortedTimestamps.end(), std::make_pair(timestamp, index));
+
+  assert(it != sortedTimestamps.end() && *it == std::make_pair(timestamp, index));
+
+  sortedTimestamps.erase(it);
+  maxTimestamps.pop_back();
+}
+
+uint32_t BlockTimestampIndex::getBlockCount() const {
+  return static_cast<uint32_t>(maxTimestamps.size());
+}
+
+uint64_t BlockTimestampIndex::getMaxTimestamp() const {
+  assert(!maxTimestamps.empty());
+
+  return maxTimestamps.back();
+}
+
+uint32_t BlockTimestampIndex::getLowerBound(uint64_t timestamp) const {
+  /* A block's greatest timestamp so far first reaches the one we're after
+     at the first block with that timestamp or later */
+  const auto it = std::lower_bound(maxTimestamps.begin(), maxTimestamps.end(), timestamp);
+
+  return static_cast<uint32_t>(std::distance(maxTimestamps.begin(), it));
+}
+
+std::vector<uint32_t> BlockTimestampIndex::getBlockIndexes(uint64_t begin, uint64_t end) const {
+  std::vector<uint32_t> indexes;
+
+  if (begin > end) {
+    return indexes;
+  }
+
+  const auto first = std::lower_bound(sortedTimestamps.begin(), sortedTimestamps.end(), std::make_pair(begin, uint32_t(0)));
+  const auto last = std::upper_bound(first, sortedTimestamps.end(), std::make_pair(end, std::numeric_limits<uint32_t>::max()));
+
+  indexes.reserve(std::distance(first, last));
+
+  for (auto it = first; it != last; ++it) {
+    indexes.push_back(it->second);
+  }
+
+  return indexes;
+}
+
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace CryptoNote {
+
+/* The timestamps of the main chain blocks, kept in memory so timestamps can
+   be turned into block indexes with a binary search rather than a database
+   read per day. Block timestamps only roughly increase, so two arrays are
+   kept: the greatest timestamp of each block and the blocks below it, which
+   never decreases, and every (timestamp, block index) pair in sorted order. */
+class BlockTimestampIndex {
+public:
+  /* Adds the block after the top block */
+  void push(uint64_t timestamp);
+  /* Removes the top block, which must have the given timestamp */
+  void pop(uint64_t timestamp);
+
+  uint32_t getBlockCount() const;
+
+  /* Greatest timestamp of any block, there must be at least one */
+  uint64_t getMaxTimestamp() const;
+
+  /* Index of the first block with a timestamp at or after the given one,
+     or getBlockCount() if there isn't one */
+  uint32_t getLowerBound(uint64_t timestamp) const;
+
+  /* Indexes of the blocks with a timestamp in [begin, end], in timestamp
+     order */
+  std::vector<uint32_t> getBlockIndexes(uint64_t begin, uint64_t end) const;
+
+private:
+  std::vector<uint64_t> maxTimestamps;
+  /* A new block's timestamp must be above the median of the last few blocks,
+     and not far in the future, so it's inserted among the entries of the
+     last few blocks, and push() and pop() only move those, not the whole
+     array */
+  std::vector<std::pair<uint64_t, uint32_t>> sortedTimestamps;
+};
+
+}
@@ -13,11 +13,13 @@
 
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
+#include "Common/Math.h"
 #include "Common/ShuffleGenerator.h"
 
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "Common/CryptoNoteTools.h"
 #include "CryptoNoteCore/BlockchainStorage.h"
+#include "CryptoNoteCore/BlockchainUtils.h"
 #include "Common/TransactionExtra.h"
 
 #include "Serialization/CryptoNoteSerialization.h"
@@ -641,6 +643,33 @@ std::vector<RawBlock> BlockchainCache::getBlocksByHeight(
     return blocks;
 }
 
+std::vector<WalletTypes::WalletBlockInfo> BlockchainCache::getWalletBlockInfos(
+    const uint64_t startHeight, const uint64_t endHeight) const
+{
+    if (endHeight <= startIndex)
+    {
+        return parent->getWalletBlockInfos(startHeight, endHeight);
+    }
+
+    std::vector<WalletTypes::WalletBlockInfo> walletBlocks;
+
+    if (startHeight < startIndex)
+    {
+        walletBlocks = parent->getWalletBlockInfos(startHeight, startIndex);
+    }
+
+    uint64_t height = std::max(startHeight, static_cast<uint64_t>(startIndex));
+
+    /* Segments only hold a handful of blocks, so these aren't worth storing,
+       just build them from the raw blocks */
+    for (const auto &rawBlock : getBlocksByHeight(height, endHeight))
+    {
+        walletBlocks.push_back(Utils::getWalletBlockInfo(height++, rawBlock));
+    }
+
+    return walletBlocks;
+}
+
 std::unordered_map<Crypto::Hash, std::vector<uint64_t>> BlockchainCache::getGlobalIndexes(
     const std::vector<Crypto::Hash> transactionHashes) const
 {
@@ -679,6 +708,35 @@ std::unordered_map<Crypto::Hash, std::vector<uint64_t>> BlockchainCache::getGlob
     return indexes;
 }
 
+std::unordered_map<Crypto::Hash, std::vector<uint64_t>> BlockchainCache::getGlobalIndexesForRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const
+{
+    if (endHeight <= startIndex)
+    {
+        return parent->getGlobalIndexesForRange(startHeight, endHeight);
+    }
+
+    std::unordered_map<Crypto::Hash, std::vector<uint64_t>> indexes;
+
+    if (startHeight < startIndex)
+    {
+        indexes = parent->getGlobalIndexesForRange(startHeight, startIndex);
+    }
+
+    const auto &transactionsByBlock = transactions.get<BlockIndexTag>();
+
+    const auto begin = transactionsByBlock.lower_bound(static_cast<uint32_t>(std::max(startHeight, static_cast<uint64_t>(startIndex))));
+    const auto end = transactionsByBlock.lower_bound(static_cast<uint32_t>(endHeight));
+
+    for (auto it = begin; it != end; ++it)
+    {
+        indexes[it->transactionHash].assign(it->globalIndexes.begin(), it->globalIndexes.end());
+    }
+
+    return indexes;
+}
+
 RawBlock BlockchainCache::getBlockByIndex(uint32_t index) const {
   return index < startIndex ? parent->getBlockByIndex(index) : storage->getBlockByIndex(index - startIndex);
 }
@@ -1098,6 +1156,16 @@ std::vector<uint64_t> BlockchainCache::getLastBlocksSizes(size_t count, uint32_t
   return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo& cb) { return cb.blockSize; });
 }
 
+uint64_t BlockchainCache::getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const {
+  // the window lies wholly below this segment, let the parent use its own window
+  if (blockIndex < startIndex && parent != nullptr) {
+    return parent->getLastBlocksSizesMedian(count, blockIndex, useGenesis);
+  }
+
+  auto sizes = getLastBlocksSizes(count, blockIndex, useGenesis);
+  return Common::medianValue(sizes);
+}
+
 uint64_t BlockchainCache::getDifficultyForNextBlock() const {
   return getDifficultyForNextBlock(getTopBlockIndex());
 }
@@ -1194,4 +1262,20 @@ void BlockchainCache::fixChildrenParent(IBlockchainCache* p) {
   }
 }
 
+uint64_t BlockchainCache::getKeyOutputCacheHits() const {
+  return 0;
+}
+
+uint64_t BlockchainCache::getKeyOutputCacheMisses() const {
+  return 0;
+}
+
+uint32_t BlockchainCache::pruneRawBlocks(uint32_t, uint32_t) {
+  throw std::runtime_error("Blockchain cache segments in memory can't be pruned");
+}
+
+uint32_t BlockchainCache::getPrunedBlockCount() const {
+  return 0;
+}
+
 }
@@ -130,6 +130,7 @@ public:
 
   std::vector<uint64_t> getLastBlocksSizes(size_t count) const override;
   std::vector<uint64_t> getLastBlocksSizes(size_t count, uint32_t blockIndex, UseGenesis) const override;
+  uint64_t getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis) const override;
 
   std::vector<uint64_t> getLastCumulativeDifficulties(size_t count, uint32_t blockIndex, UseGenesis) const override;
   std::vector<uint64_t> getLastCumulativeDifficulties(size_t count) const override;
@@ -179,6 +180,10 @@ public:
   virtual std::unordered_map<Crypto::Hash, std::vector<uint64_t>> getGlobalIndexes(
     const std::vector<Crypto::Hash> transactionHashes) const override;
 
+  virtual std::unordered_map<Crypto::Hash, std::vector<uint64_t>> getGlobalIndexesForRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const override;
+
   virtual RawBlock getBlockByIndex(uint32_t index) const override;
   virtual BinaryArray getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashes() const override;
@@ -194,6 +199,23 @@ public:
     const uint64_t startHeight,
     const uint64_t endHeight) const override;
 
+  virtual std::vector<WalletTypes::WalletBlockInfo> getWalletBlockInfos(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const override;
+
+  /*
+   * Outputs are kept in memory, these methods always return zero
+   */
+  virtual uint64_t getKeyOutputCacheHits() const override;
+  virtual uint64_t getKeyOutputCacheMisses() const override;
+
+  /*
+   * Segments in memory are near the top, and are never pruned, so
+   * pruneRawBlocks throws
+   */
+  virtual uint32_t pruneRawBlocks(uint32_t, uint32_t) override;
+  virtual uint32_t getPrunedBlockCount() const override;
+
 private:
 
   struct BlockIndexTag {};
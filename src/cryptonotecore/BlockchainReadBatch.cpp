@@ -139,6 +139,22 @@ BlockchainReadBatch& BlockchainReadBatch::requestKeyOutputInfo(IBlockchainCache:
   return *this;
 }
 
+BlockchainReadBatch& BlockchainReadBatch::requestWalletBlockInfos(uint64_t startHeight, uint64_t endHeight) {
+  for (uint64_t i = startHeight; i < endHeight; ++i) {
+    state.walletBlockInfos.emplace(static_cast<uint32_t>(i), WalletTypes::WalletBlockInfo());
+  }
+
+  return *this;
+}
+
+BlockchainReadBatch& BlockchainReadBatch::requestGlobalIndexesByBlocks(uint64_t startHeight, uint64_t endHeight) {
+  for (uint64_t i = startHeight; i < endHeight; ++i) {
+    state.globalIndexesByBlocks.emplace(static_cast<uint32_t>(i), std::vector<TransactionGlobalIndexes>());
+  }
+
+  return *this;
+}
+
 BlockchainReadResult BlockchainReadBatch::extractResult() {
   assert(resultSubmitted);
   auto st = std::move(state);
@@ -168,6 +184,8 @@ std::vector<std::string> BlockchainReadBatch::getRawKeys() const {
   DB::serializeKeys(rawKeys, DB::PAYMENT_ID_TO_TX_HASH_PREFIX, state.transactionHashesByPaymentIds);
   DB::serializeKeys(rawKeys, DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX, state.blockHashesByTimestamp);
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_KEY_PREFIX, state.keyOutputKeys);
+  DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_WALLET_BLOCK_INFO_PREFIX, state.walletBlockInfos);
+  DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_GLOBAL_INDEXES_PREFIX, state.globalIndexesByBlocks);
 
   if (state.lastBlockIndex.second) {
     rawKeys.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX, DB::LAST_BLOCK_INDEX_KEY));
@@ -261,6 +279,14 @@ const KeyOutputKeyResult& BlockchainReadResult::getKeyOutputInfo() const {
   return state.keyOutputKeys;
 }
 
+const std::unordered_map<uint32_t, WalletTypes::WalletBlockInfo>& BlockchainReadResult::getWalletBlockInfos() const {
+  return state.walletBlockInfos;
+}
+
+const std::unordered_map<uint32_t, std::vector<TransactionGlobalIndexes>>& BlockchainReadResult::getGlobalIndexesByBlocks() const {
+  return state.globalIndexesByBlocks;
+}
+
 void BlockchainReadBatch::submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) {
   assert(state.size() == values.size());
   assert(values.size() == resultStates.size());
@@ -282,6 +308,8 @@ void BlockchainReadBatch::submitRawResult(const std::vector<std::string>& values
   DB::deserializeValues(state.transactionHashesByPaymentIds, iter, DB::PAYMENT_ID_TO_TX_HASH_PREFIX);
   DB::deserializeValues(state.blockHashesByTimestamp, iter, DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX);
   DB::deserializeValues(state.keyOutputKeys, iter, DB::KEY_OUTPUT_KEY_PREFIX);
+  DB::deserializeValues(state.walletBlockInfos, iter, DB::BLOCK_INDEX_TO_WALLET_BLOCK_INFO_PREFIX);
+  DB::deserializeValues(state.globalIndexesByBlocks, iter, DB::BLOCK_INDEX_TO_GLOBAL_INDEXES_PREFIX);
 
   DB::deserializeValue(state.lastBlockIndex, iter, DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX);
   DB::deserializeValue(state.keyOutputAmountsCount, iter, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX);
@@ -304,6 +332,8 @@ keyOutputGlobalIndexesForAmounts(std::move(state.keyOutputGlobalIndexesForAmount
 rawBlocks(std::move(state.rawBlocks)),
 blockHashesByTimestamp(std::move(state.blockHashesByTimestamp)),
 keyOutputKeys(std::move(state.keyOutputKeys)),
+walletBlockInfos(std::move(state.walletBlockInfos)),
+globalIndexesByBlocks(std::move(state.globalIndexesByBlocks)),
 closestTimestampBlockIndex(std::move(state.closestTimestampBlockIndex)),
 lastBlockIndex(std::move(state.lastBlockIndex)),
 keyOutputAmountsCount(std::move(state.keyOutputAmountsCount)),
@@ -329,6 +359,8 @@ size_t BlockchainReadState::size() const {
     transactionHashesByPaymentIds.size() +
     blockHashesByTimestamp.size() +
     keyOutputKeys.size() +
+    walletBlockInfos.size() +
+    globalIndexesByBlocks.size() +
     (lastBlockIndex.second ? 1 : 0) +
     (keyOutputAmountsCount.second ? 1 : 0) +
     (transactionsCount.second ? 1 : 0);
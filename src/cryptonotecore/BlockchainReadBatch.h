@@ -68,6 +68,8 @@ struct BlockchainReadState {
   std::unordered_map<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash> transactionHashesByPaymentIds;
   std::unordered_map<uint64_t, std::vector<Crypto::Hash>> blockHashesByTimestamp;
   KeyOutputKeyResult keyOutputKeys;
+  std::unordered_map<uint32_t, WalletTypes::WalletBlockInfo> walletBlockInfos;
+  std::unordered_map<uint32_t, std::vector<TransactionGlobalIndexes>> globalIndexesByBlocks;
 
   std::pair<uint32_t, bool> lastBlockIndex = { 0, false };
   std::pair<uint32_t, bool> keyOutputAmountsCount = { {}, false };
@@ -104,6 +106,8 @@ public:
   const std::unordered_map<uint64_t, std::vector<Crypto::Hash> >& getBlockHashesByTimestamp() const;
   const std::pair<uint64_t, bool>& getTransactionsCount() const;
   const KeyOutputKeyResult& getKeyOutputInfo() const;
+  const std::unordered_map<uint32_t, WalletTypes::WalletBlockInfo>& getWalletBlockInfos() const;
+  const std::unordered_map<uint32_t, std::vector<TransactionGlobalIndexes>>& getGlobalIndexesByBlocks() const;
 
 private:
   BlockchainReadState state;
@@ -133,6 +137,8 @@ public:
   BlockchainReadBatch& requestBlockHashesByTimestamp(uint64_t timestamp);
   BlockchainReadBatch& requestTransactionsCount();
   BlockchainReadBatch& requestKeyOutputInfo(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex);
+  BlockchainReadBatch& requestWalletBlockInfos(uint64_t startHeight, uint64_t endHeight);
+  BlockchainReadBatch& requestGlobalIndexesByBlocks(uint64_t startHeight, uint64_t endHeight);
 
   std::vector<std::string> getRawKeys() const override;
   void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override;
@@ -17,6 +17,14 @@
 
 #include "BlockchainUtils.h"
 
+#include <algorithm>
+
+#include <Common/StringTools.h>
+
+#include <config/Constants.h>
+
+#include <CryptoNoteCore/CryptoNoteFormatUtils.h>
+
 namespace CryptoNote {
 namespace Utils {
 
@@ -36,5 +44,211 @@ bool restoreCachedTransactions(const std::vector<BinaryArray>& binaryTransaction
   return true;
 }
 
+WalletTypes::WalletBlockInfo getWalletBlockInfo(
+    uint64_t blockHeight,
+    const CachedBlock& block,
+    const CachedTransaction& baseTransaction,
+    const std::vector<CachedTransaction>& transactions)
+{
+    WalletTypes::WalletBlockInfo walletBlock;
+
+    walletBlock.blockHeight = blockHeight;
+    walletBlock.blockHash = block.getBlockHash();
+    walletBlock.blockTimestamp = block.getBlock().timestamp;
+
+    walletBlock.coinbaseTransaction = getRawCoinbaseTransaction(baseTransaction);
+
+    walletBlock.transactions.reserve(transactions.size());
+
+    for (const auto &transaction : transactions)
+    {
+        walletBlock.transactions.push_back(getRawTransaction(transaction));
+    }
+
+    return walletBlock;
+}
+
+WalletTypes::WalletBlockInfo getWalletBlockInfo(uint64_t blockHeight, const RawBlock& rawBlock)
+{
+    BlockTemplate block;
+
+    fromBinaryArray(block, rawBlock.block);
+
+    const CachedBlock cachedBlock(block);
+    const CachedTransaction baseTransaction(block.baseTransaction);
+
+    std::vector<CachedTransaction> transactions;
+    transactions.reserve(rawBlock.transactions.size());
+
+    /* Keep the raw bytes, so the hashes are of the transactions as they
+       were sent to us */
+    for (const auto &transaction : rawBlock.transactions)
+    {
+        transactions.emplace_back(transaction);
+    }
+
+    return getWalletBlockInfo(blockHeight, cachedBlock, baseTransaction, transactions);
+}
+
+WalletTypes::RawCoinbaseTransaction getRawCoinbaseTransaction(const CachedTransaction& cachedTransaction)
+{
+    const Transaction &t = cachedTransaction.getTransaction();
+
+    WalletTypes::RawCoinbaseTransaction transaction;
+
+    transaction.hash = cachedTransaction.getTransactionHash();
+
+    transaction.transactionPublicKey = getPubKeyFromExtra(t.extra);
+
+    transaction.unlockTime = t.unlockTime;
+
+    /* Fill in the simplified key outputs */
+    for (const auto &output : t.outputs)
+    {
+        WalletTypes::KeyOutput keyOutput;
+
+        keyOutput.amount = output.amount;
+        keyOutput.key = boost::get<CryptoNote::KeyOutput>(output.target).key;
+
+        transaction.keyOutputs.push_back(keyOutput);
+    }
+
+    return transaction;
+}
+
+WalletTypes::RawTransaction getRawTransaction(const CachedTransaction& cachedTransaction)
+{
+    const Transaction &t = cachedTransaction.getTransaction();
+
+    WalletTypes::RawTransaction transaction;
+
+    transaction.hash = cachedTransaction.getTransactionHash();
+
+    /* Transaction public key, used for decrypting transactions along with
+       private view key */
+    transaction.transactionPublicKey = getPubKeyFromExtra(t.extra);
+
+    /* Get the payment ID if it exists (Empty string if it doesn't) */
+    transaction.paymentID = getPaymentIDFromExtra(t.extra);
+
+    transaction.unlockTime = t.unlockTime;
+
+    /* Simplify the outputs */
+    for (const auto &output : t.outputs)
+    {
+        WalletTypes::KeyOutput keyOutput;
+
+        keyOutput.amount = output.amount;
+        keyOutput.key = boost::get<CryptoNote::KeyOutput>(output.target).key;
+
+        transaction.keyOutputs.push_back(keyOutput);
+    }
+
+    /* Simplify the inputs */
+    for (const auto &input : t.inputs)
+    {
+        transaction.keyInputs.push_back(boost::get<CryptoNote::KeyInput>(input));
+    }
+
+    return transaction;
+}
+
+/* Public key looks like this
+
+   [...data...] 0x01 [public key] [...data...]
+
+*/
+Crypto::PublicKey getPubKeyFromExtra(const std::vector<uint8_t> &extra)
+{
+    Crypto::PublicKey publicKey;
+
+    const int pubKeySize = 32;
+
+    for (size_t i = 0; i < extra.size(); i++)
+    {
+        /* If the following data is the transaction public key, this is
+           indicated by the preceding value being 0x01. */
+        if (extra[i] == Constants::TX_EXTRA_PUBKEY_IDENTIFIER)
+        {
+            /* The amount of data remaining in the vector (minus one because
+               we start reading the public key from the next character) */
+            size_t dataRemaining = extra.size() - i - 1;
+
+            /* We need to check that there is enough space following the tag,
+               as someone could just pop a random 0x01 in there and make our
+               code mess up */
+            if (dataRemaining < pubKeySize)
+            {
+                return publicKey;
+            }
+
+            const auto dataBegin = extra.begin() + i + 1;
+            const auto dataEnd = dataBegin + pubKeySize;
+
+            /* Copy the data from the vector to the array */
+            std::copy(dataBegin, dataEnd, std::begin(publicKey.data));
+
+            return publicKey;
+        }
+    }
+
+    /* Couldn't find the tag */
+    return publicKey;
+}
+
+/* Payment ID looks like this (payment ID is stored in extra nonce)
+
+   [...data...] 0x02 [size of extra nonce] 0x00 [payment ID] [...data...]
+
+*/
+std::string getPaymentIDFromExtra(const std::vector<uint8_t> &extra)
+{
+    const int paymentIDSize = 32;
+
+    for (size_t i = 0; i < extra.size(); i++)
+    {
+        /* Extra nonce tag found */
+        if (extra[i] == Constants::TX_EXTRA_NONCE_IDENTIFIER)
+        {
+            /* Skip the extra nonce tag */
+            size_t dataRemaining = extra.size() - i - 1;
+
+            /* Not found, not enough space. We need a +1, since payment ID
+               is stored inside extra nonce, with a special tag for it,
+               and there is a size parameter right after the extra nonce
+               tag */
+            if (dataRemaining < paymentIDSize + 1 + 1)
+            {
+                return std::string();
+            }
+
+            /* Payment ID in extra nonce */
+            if (extra[i+2] == Constants::TX_EXTRA_PAYMENT_ID_IDENTIFIER)
+            {
+                /* Plus three to skip the two 0x02 0x00 tags and the size value */
+                const auto dataBegin = extra.begin() + i + 3;
+                const auto dataEnd = dataBegin + paymentIDSize;
+
+                Crypto::Hash paymentIDHash;
+
+                /* Copy the payment ID into the hash */
+                std::copy(dataBegin, dataEnd, std::begin(paymentIDHash.data));
+
+                /* Convert to a string */
+                std::string paymentID = Common::podToHex(paymentIDHash);
+
+                /* Convert it to lower case */
+                std::transform(paymentID.begin(), paymentID.end(),
+                               paymentID.begin(), ::tolower);
+
+                return paymentID;
+            }
+        }
+    }
+
+    /* Not found */
+    return std::string();
+}
+
 }
 }
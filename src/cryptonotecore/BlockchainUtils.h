@@ -17,16 +17,38 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
+#include "CachedBlock.h"
 #include "CachedTransaction.h"
 #include "CryptoNote.h"
 #include "Common/CryptoNoteTools.h"
 
+#include <WalletTypes.h>
+
 namespace CryptoNote {
 namespace Utils {
 
 bool restoreCachedTransactions(const std::vector<BinaryArray>& binaryTransactions, std::vector<CachedTransaction>& transactions);
 
+/* The parts of a block a wallet needs to sync - the outputs, key images,
+   transaction public keys and payment IDs */
+WalletTypes::WalletBlockInfo getWalletBlockInfo(
+  uint64_t blockHeight,
+  const CachedBlock& block,
+  const CachedTransaction& baseTransaction,
+  const std::vector<CachedTransaction>& transactions);
+
+WalletTypes::WalletBlockInfo getWalletBlockInfo(uint64_t blockHeight, const RawBlock& rawBlock);
+
+WalletTypes::RawCoinbaseTransaction getRawCoinbaseTransaction(const CachedTransaction& transaction);
+
+WalletTypes::RawTransaction getRawTransaction(const CachedTransaction& transaction);
+
+Crypto::PublicKey getPubKeyFromExtra(const std::vector<uint8_t> &extra);
+
+std::string getPaymentIDFromExtra(const std::vector<uint8_t> &extra);
+
 } //namespace Utils
 } //namespace CryptoNote
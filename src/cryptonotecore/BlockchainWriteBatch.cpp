@@ -105,6 +105,16 @@ BlockchainWriteBatch& BlockchainWriteBatch::insertKeyOutputInfo(IBlockchainCache
   return *this;
 }
 
+BlockchainWriteBatch& BlockchainWriteBatch::insertWalletBlockInfo(uint32_t blockIndex, const WalletTypes::WalletBlockInfo& walletBlockInfo) {
+  rawDataToInsert.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_WALLET_BLOCK_INFO_PREFIX, blockIndex, walletBlockInfo));
+  return *this;
+}
+
+BlockchainWriteBatch& BlockchainWriteBatch::insertGlobalIndexes(uint32_t blockIndex, const std::vector<TransactionGlobalIndexes>& globalIndexes) {
+  rawDataToInsert.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_GLOBAL_INDEXES_PREFIX, blockIndex, globalIndexes));
+  return *this;
+}
+
 BlockchainWriteBatch& BlockchainWriteBatch::removeSpentKeyImages(uint32_t blockIndex, const std::vector<Crypto::KeyImage>& spentKeyImages) {
   rawKeysToRemove.reserve(rawKeysToRemove.size() + spentKeyImages.size() + 1);
   rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX, blockIndex));
@@ -165,6 +175,16 @@ BlockchainWriteBatch&BlockchainWriteBatch::removeKeyOutputInfo(IBlockchainCache:
   return *this;
 }
 
+BlockchainWriteBatch& BlockchainWriteBatch::removeWalletBlockInfo(uint32_t blockIndex) {
+  rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_WALLET_BLOCK_INFO_PREFIX, blockIndex));
+  return *this;
+}
+
+BlockchainWriteBatch& BlockchainWriteBatch::removeGlobalIndexes(uint32_t blockIndex) {
+  rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_GLOBAL_INDEXES_PREFIX, blockIndex));
+  return *this;
+}
+
 std::vector<std::pair<std::string, std::string>> BlockchainWriteBatch::extractRawDataToInsert() {
   return std::move(rawDataToInsert);
 }
@@ -40,6 +40,8 @@ public:
   BlockchainWriteBatch& insertKeyOutputAmounts(const std::set<IBlockchainCache::Amount>& amounts, uint32_t totalKeyOutputAmountsCount);
   BlockchainWriteBatch& insertTimestamp(uint64_t timestamp, const std::vector<Crypto::Hash>& blockHashes);
   BlockchainWriteBatch& insertKeyOutputInfo(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex, const KeyOutputInfo& outputInfo);
+  BlockchainWriteBatch& insertWalletBlockInfo(uint32_t blockIndex, const WalletTypes::WalletBlockInfo& walletBlockInfo);
+  BlockchainWriteBatch& insertGlobalIndexes(uint32_t blockIndex, const std::vector<TransactionGlobalIndexes>& globalIndexes);
 
   BlockchainWriteBatch& removeSpentKeyImages(uint32_t blockIndex, const std::vector<Crypto::KeyImage>& spentKeyImages);
   BlockchainWriteBatch& removeCachedTransaction(const Crypto::Hash& transactionHash, uint64_t totalTxsCount);
@@ -50,6 +52,8 @@ public:
   BlockchainWriteBatch& removeClosestTimestampBlockIndex(uint64_t timestamp);
   BlockchainWriteBatch& removeTimestamp(uint64_t timestamp);
   BlockchainWriteBatch& removeKeyOutputInfo(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex);
+  BlockchainWriteBatch& removeWalletBlockInfo(uint32_t blockIndex);
+  BlockchainWriteBatch& removeGlobalIndexes(uint32_t blockIndex);
 
   std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override;
   std::vector<std::string> extractRawKeysToRemove() override;
@@ -72,6 +72,32 @@ const Crypto::Hash& CachedBlock::getBlockLongHash() const {
   return blockLongHash.get();
 }
 
+void CachedBlock::calculateBlockLongHashes(const std::vector<const CachedBlock*>& cachedBlocks) {
+  std::vector<const void*> data;
+  std::vector<size_t> lengths;
+  std::vector<Hash*> hashes;
+
+  for (const auto cachedBlock : cachedBlocks) {
+    if (cachedBlock->blockLongHash.is_initialized()) {
+      continue;
+    }
+
+    if (cachedBlock->block.majorVersion < BLOCK_MAJOR_VERSION_5) {
+      cachedBlock->getBlockLongHash();
+      continue;
+    }
+
+    const auto& rawHashingBlock = cachedBlock->getParentBlockHashingBinaryArray(true);
+    cachedBlock->blockLongHash = Hash();
+
+    data.push_back(rawHashingBlock.data());
+    lengths.push_back(rawHashingBlock.size());
+    hashes.push_back(&cachedBlock->blockLongHash.get());
+  }
+
+  cn_turtle_lite_slow_hash_v2_multi(data.data(), lengths.data(), hashes.data(), hashes.size());
+}
+
 const Crypto::Hash& CachedBlock::getAuxiliaryBlockHeaderHash() const {
   if (!auxiliaryBlockHeaderHash.is_initialized()) {
     auxiliaryBlockHeaderHash = getObjectHash(getBlockHashingBinaryArray());
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <boost/optional.hpp>
 #include <CryptoNote.h>
 
@@ -24,6 +26,11 @@ public:
   const BinaryArray& getParentBlockHashingBinaryArray(bool headerOnly) const;
   uint32_t getBlockIndex() const;
 
+  /* Works out the long hashes of several blocks at once, which is quicker
+     per block than getBlockLongHash for blocks hashed with CryptoNight
+     Turtle Lite v2 */
+  static void calculateBlockLongHashes(const std::vector<const CachedBlock*>& cachedBlocks);
+
 private:
   const BlockTemplate& block;
   mutable boost::optional<BinaryArray> blockHashingBinaryArray;
@@ -7,8 +7,12 @@
 
 #include <algorithm>
 
+#include <deque>
+
 #include <numeric>
 
+#include <optional>
+
 #include <Common/CryptoNoteTools.h>
 #include <Common/ShuffleGenerator.h>
 #include <Common/Math.h>
@@ -58,6 +62,10 @@ std::vector<T> preallocateVector(size_t elements) {
   return vect;
 }
 UseGenesis addGenesisBlock = UseGenesis(true);
+UseGenesis skipGenesisBlock = UseGenesis(false);
+
+/* Ring signatures handed to crypto_ops::checkRingSignatures() at once */
+const size_t RING_SIGNATURE_BATCH_SIZE = 16;
 
 class TransactionSpentInputsChecker {
 public:
@@ -159,8 +167,7 @@ int64_t getEmissionChange(const Currency& currency, IBlockchainCache& segment, u
   uint64_t reward = 0;
   int64_t emissionChange = 0;
   auto alreadyGeneratedCoins = segment.getAlreadyGeneratedCoins(previousBlockIndex);
-  auto lastBlocksSizes = segment.getLastBlocksSizes(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
-  auto blocksSizeMedian = Common::medianValue(lastBlocksSizes);
+  auto blocksSizeMedian = segment.getLastBlocksSizesMedian(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
   if (!currency.getBlockReward(cachedBlock.getBlock().majorVersion, blocksSizeMedian,
                                cumulativeSize, alreadyGeneratedCoins, cumulativeFee, reward, emissionChange)) {
     throw std::system_error(make_error_code(error::BlockValidationError::CUMULATIVE_BLOCK_SIZE_TOO_BIG));
@@ -191,14 +198,45 @@ uint32_t findCommonRoot(IMainChainStorage& storage, IBlockchainCache& rootSegmen
 }
 
 const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
+const std::chrono::seconds MAIN_CHAIN_STORAGE_COMMIT_INTERVAL = std::chrono::seconds(5);
+
+/* How many blocks importBlocksFromStorage reads and parses ahead of the one
+   being pushed */
+const size_t IMPORT_PIPELINE_DEPTH = 500;
+
+/* How many blocks importBlocksFromStorage reads from the storage at a time */
+const uint32_t IMPORT_READ_BATCH_SIZE = 100;
+
+/* A block read from the main chain storage, with everything that doesn't
+   depend on the blocks before it already computed */
+struct ImportedBlock {
+  RawBlock rawBlock;
+  BlockTemplate blockTemplate;
+  /* Refers to blockTemplate, so an ImportedBlock must never be moved */
+  std::optional<CachedBlock> cachedBlock;
+  std::vector<CachedTransaction> transactions;
+  TransactionValidatorState spentOutputs;
+  uint64_t cumulativeSize = 0;
+  uint64_t cumulativeFee = 0;
+};
 
 }
 
 Core::Core(const Currency& currency, std::shared_ptr<Logging::ILogger> logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
-           std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage)
+           std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage,
+           uint32_t validationThreads, uint32_t pruneDepth)
     : currency(currency), dispatcher(dispatcher), contextGroup(dispatcher), logger(logger, "Core"), checkpoints(std::move(checkpoints)),
       upgradeManager(new UpgradeManager()), blockchainCacheFactory(std::move(blockchainCacheFactory)),
-      mainChainStorage(std::move(mainchainStorage)), initialized(false) {
+      mainChainStorage(std::move(mainchainStorage)), initialized(false),
+      signatureCache(CryptoNote::VALIDATION_SIGNATURE_CACHE_SIZE), pruneDepth(pruneDepth) {
+
+  if (validationThreads == 0) {
+    validationThreads = std::thread::hardware_concurrency();
+  }
+
+  if (validationThreads > 1) {
+    validationThreadPool = std::make_unique<ThreadPool>(validationThreads);
+  }
 
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_3, currency.upgradeHeight(BLOCK_MAJOR_VERSION_3));
@@ -254,6 +292,12 @@ Crypto::Hash Core::getTopBlockHash() const {
   return chainsLeaves[0]->getTopBlockHash();
 }
 
+uint32_t Core::getPrunedHeight() const {
+  throwIfNotInitialized();
+
+  return getRootSegment()->getPrunedBlockCount();
+}
+
 Crypto::Hash Core::getBlockHashByIndex(uint32_t blockIndex) const {
   assert(!chainsStorage.empty());
   assert(!chainsLeaves.empty());
@@ -329,7 +373,9 @@ std::vector<RawBlock> Core::getBlocks(uint32_t minIndex, uint32_t count) const {
     blocks.reserve(count);
     while (cache) {
       if (cache->getTopBlockIndex() >= maxIndex) {
-        auto minChainIndex = std::max(minIndex, cache->getStartBlockIndex());
+        /* Only the header of a pruned block is left, so they're left out,
+           as the by hash overload reports them missed */
+        auto minChainIndex = std::max({minIndex, cache->getStartBlockIndex(), cache->getPrunedBlockCount()});
         for (; minChainIndex <= maxIndex; --maxIndex) {
           blocks.emplace_back(cache->getBlockByIndex(maxIndex));
           if (maxIndex == 0) {
@@ -362,6 +408,12 @@ void Core::getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<R
       uint32_t blockIndex = blockchainSegment->getBlockIndex(hash);
       assert(blockIndex <= blockchainSegment->getTopBlockIndex());
 
+      /* Only the header of a pruned block is left, which is no use to a peer */
+      if (blockIndex < blockchainSegment->getPrunedBlockCount()) {
+        missedHashes.push_back(hash);
+        continue;
+      }
+
       blocks.push_back(blockchainSegment->getBlockByIndex(blockIndex));
     }
   }
@@ -665,33 +717,8 @@ bool Core::getWalletSyncData(
             return true;
         }
 
-        std::vector<RawBlock> rawBlocks = mainChain->getBlocksByHeight(startIndex, endIndex);
-
-        for (const auto rawBlock : rawBlocks)
-        {
-            BlockTemplate block;
-
-            fromBinaryArray(block, rawBlock.block);
-
-            WalletTypes::WalletBlockInfo walletBlock;
-
-            walletBlock.blockHeight = startIndex++;
-            walletBlock.blockHash = CachedBlock(block).getBlockHash();
-            walletBlock.blockTimestamp = block.timestamp;
-
-            walletBlock.coinbaseTransaction = getRawCoinbaseTransaction(
-                block.baseTransaction
-            );
-
-            for (const auto &transaction : rawBlock.transactions)
-            {
-                walletBlock.transactions.push_back(
-                    getRawTransaction(transaction)
-                );
-            }
-
-            walletBlocks.push_back(walletBlock);
-        }
+        /* Precomputed when the blocks were added, so this is just a range read */
+        walletBlocks = mainChain->getWalletBlockInfos(startIndex, endIndex);
 
         return true;
     }
@@ -702,170 +729,6 @@ bool Core::getWalletSyncData(
     }
 }
 
-WalletTypes::RawCoinbaseTransaction Core::getRawCoinbaseTransaction(
-    const CryptoNote::Transaction &t)
-{
-    WalletTypes::RawCoinbaseTransaction transaction;
-
-    transaction.hash = getBinaryArrayHash(toBinaryArray(t));
-
-    transaction.transactionPublicKey = getPubKeyFromExtra(t.extra);
-
-    transaction.unlockTime = t.unlockTime;
-
-    /* Fill in the simplified key outputs */
-    for (const auto &output : t.outputs)
-    {
-        WalletTypes::KeyOutput keyOutput;
-
-        keyOutput.amount = output.amount;
-        keyOutput.key = boost::get<CryptoNote::KeyOutput>(output.target).key;
-
-        transaction.keyOutputs.push_back(keyOutput);
-    }
-
-    return transaction;
-}
-
-WalletTypes::RawTransaction Core::getRawTransaction(
-    const std::vector<uint8_t> &rawTX)
-{
-    Transaction t;
-
-    /* Convert the binary array to a transaction */
-    fromBinaryArray(t, rawTX);
-
-    WalletTypes::RawTransaction transaction;
-
-    /* Get the transaction hash from the binary array */
-    transaction.hash = getBinaryArrayHash(rawTX);
-
-    /* Transaction public key, used for decrypting transactions along with
-       private view key */
-    transaction.transactionPublicKey = getPubKeyFromExtra(t.extra);
-
-    /* Get the payment ID if it exists (Empty string if it doesn't) */
-    transaction.paymentID = getPaymentIDFromExtra(t.extra);
-
-    transaction.unlockTime = t.unlockTime;
-
-    /* Simplify the outputs */
-    for (const auto &output : t.outputs)
-    {
-        WalletTypes::KeyOutput keyOutput;
-
-        keyOutput.amount = output.amount;
-        keyOutput.key = boost::get<CryptoNote::KeyOutput>(output.target).key;
-
-        transaction.keyOutputs.push_back(keyOutput);
-    }
-
-    /* Simplify the inputs */
-    for (const auto &input : t.inputs)
-    {
-        transaction.keyInputs.push_back(boost::get<CryptoNote::KeyInput>(input));
-    }
-
-    return transaction;
-}
-
-/* Public key looks like this
-
-   [...data...] 0x01 [public key] [...data...]
-
-*/
-Crypto::PublicKey Core::getPubKeyFromExtra(const std::vector<uint8_t> &extra)
-{
-    Crypto::PublicKey publicKey;
-
-    const int pubKeySize = 32;
-
-    for (size_t i = 0; i < extra.size(); i++)
-    {
-        /* If the following data is the transaction public key, this is
-           indicated by the preceding value being 0x01. */
-        if (extra[i] == Constants::TX_EXTRA_PUBKEY_IDENTIFIER)
-        {
-            /* The amount of data remaining in the vector (minus one because
-               we start reading the public key from the next character) */
-            size_t dataRemaining = extra.size() - i - 1;
-
-            /* We need to check that there is enough space following the tag,
-               as someone could just pop a random 0x01 in there and make our
-               code mess up */
-            if (dataRemaining < pubKeySize)
-            {
-                return publicKey;
-            }
-
-            const auto dataBegin = extra.begin() + i + 1;
-            const auto dataEnd = dataBegin + pubKeySize;
-
-            /* Copy the data from the vector to the array */
-            std::copy(dataBegin, dataEnd, std::begin(publicKey.data));
-
-            return publicKey;
-        }
-    }
-
-    /* Couldn't find the tag */
-    return publicKey;
-}
-
-/* Payment ID looks like this (payment ID is stored in extra nonce)
-
-   [...data...] 0x02 [size of extra nonce] 0x00 [payment ID] [...data...]
-
-*/
-std::string Core::getPaymentIDFromExtra(const std::vector<uint8_t> &extra)
-{
-    const int paymentIDSize = 32;
-
-    for (size_t i = 0; i < extra.size(); i++)
-    {
-        /* Extra nonce tag found */
-        if (extra[i] == Constants::TX_EXTRA_NONCE_IDENTIFIER)
-        {
-            /* Skip the extra nonce tag */
-            size_t dataRemaining = extra.size() - i - 1;
-
-            /* Not found, not enough space. We need a +1, since payment ID
-               is stored inside extra nonce, with a special tag for it,
-               and there is a size parameter right after the extra nonce
-               tag */
-            if (dataRemaining < paymentIDSize + 1 + 1)
-            {
-                return std::string();
-            }
-
-            /* Payment ID in extra nonce */
-            if (extra[i+2] == Constants::TX_EXTRA_PAYMENT_ID_IDENTIFIER)
-            {
-                /* Plus three to skip the two 0x02 0x00 tags and the size value */
-                const auto dataBegin = extra.begin() + i + 3;
-                const auto dataEnd = dataBegin + paymentIDSize;
-
-                Crypto::Hash paymentIDHash;
-
-                /* Copy the payment ID into the hash */
-                std::copy(dataBegin, dataEnd, std::begin(paymentIDHash.data));
-
-                /* Convert to a string */
-                std::string paymentID = Common::podToHex(paymentIDHash);
-
-                /* Convert it to lower case */
-                std::transform(paymentID.begin(), paymentID.end(),
-                               paymentID.begin(), ::tolower);
-
-                return paymentID;
-            }
-        }
-    }
-
-    /* Not found */
-    return std::string();
-}
-
 std::optional<BinaryArray> Core::getTransaction(const Crypto::Hash& hash) const {
     throwIfNotInitialized();
     auto segment = findSegmentContainingTransaction(hash);
@@ -930,13 +793,18 @@ uint64_t Core::getBlockDifficulty(uint32_t blockIndex) const {
   return difficulties[0];
 }
 
-// TODO: just use mainChain->getDifficultyForNextBlock() ?
 uint64_t Core::getDifficultyForNextBlock() const {
   throwIfNotInitialized();
   IBlockchainCache* mainChain = chainsLeaves[0];
 
   uint32_t topBlockIndex = mainChain->getTopBlockIndex();
 
+  // From LWMA onwards the window doesn't depend on the block version, so the
+  // segment can answer from its own rolling window
+  if (topBlockIndex >= CryptoNote::parameters::LWMA_2_DIFFICULTY_BLOCK_INDEX) {
+    return mainChain->getDifficultyForNextBlock();
+  }
+
   uint8_t nextBlockMajorVersion = getBlockMajorVersionForHeight(topBlockIndex);
 
   size_t blocksCount = std::min(static_cast<size_t>(topBlockIndex), currency.difficultyBlocksCountByBlockVersion(nextBlockMajorVersion, topBlockIndex));
@@ -1000,6 +868,14 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
   auto previousBlockIndex = cache->getBlockIndex(previousBlockHash);
 
   bool addOnTop = cache->getTopBlockIndex() == previousBlockIndex;
+
+  /* We no longer have the transactions to switch to a chain which forks
+     below the blocks we've pruned */
+  if (!addOnTop && previousBlockIndex + 1 < cache->getPrunedBlockCount()) {
+    logger(Logging::DEBUGGING) << "Block " << blockStr << " rejected, it forks below the pruned blocks";
+    return error::AddBlockErrorCode::REJECTED_AS_ORPHANED;
+  }
+
   auto maxBlockCumulativeSize = currency.maxBlockCumulativeSize(previousBlockIndex + 1);
   if (cumulativeBlockSize > maxBlockCumulativeSize) {
     logger(Logging::DEBUGGING) << "Block " << blockStr << " has too big cumulative size";
@@ -1091,22 +967,43 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
 
   uint64_t cumulativeFee = 0;
 
+  /* Run the cheap checks first, and queue up the ring signatures so we can
+     verify them all at once on the validation threads */
+  std::vector<RingSignatureCheck> signatureChecks;
+
   for (const auto& transaction : transactions) {
     uint64_t fee = 0;
-    auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex);
+    auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex, &signatureChecks);
     if (transactionValidationResult) {
-      logger(Logging::DEBUGGING) << "Failed to validate transaction " << transaction.getTransactionHash() << ": " << transactionValidationResult.message();
+      /* A signature queued before this failure would have been rejected
+         first when validating serially, so report that instead */
+      const size_t failedSignature = checkRingSignatures(signatureChecks);
+
+      if (failedSignature != signatureChecks.size()) {
+        transactionValidationResult = error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+        logger(Logging::DEBUGGING) << "Failed to validate transaction " << signatureChecks[failedSignature].transactionHash << ": " << transactionValidationResult.message();
+      } else {
+        logger(Logging::DEBUGGING) << "Failed to validate transaction " << transaction.getTransactionHash() << ": " << transactionValidationResult.message();
+      }
+
       return transactionValidationResult;
     }
 
     cumulativeFee += fee;
   }
 
+  const size_t failedSignature = checkRingSignatures(signatureChecks);
+
+  if (failedSignature != signatureChecks.size()) {
+    std::error_code transactionValidationResult = error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+    logger(Logging::DEBUGGING) << "Failed to validate transaction " << signatureChecks[failedSignature].transactionHash << ": " << transactionValidationResult.message();
+    return transactionValidationResult;
+  }
+
   uint64_t reward = 0;
   int64_t emissionChange = 0;
   auto alreadyGeneratedCoins = cache->getAlreadyGeneratedCoins(previousBlockIndex);
-  auto lastBlocksSizes = cache->getLastBlocksSizes(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
-  auto blocksSizeMedian = Common::medianValue(lastBlocksSizes);
+  auto blocksSizeMedian = cache->getLastBlocksSizesMedian(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
 
   if (!currency.getBlockReward(cachedBlock.getBlock().majorVersion, blocksSizeMedian,
                                cumulativeBlockSize, alreadyGeneratedCoins, cumulativeFee, reward, emissionChange)) {
@@ -1143,11 +1040,14 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
 
         cache->pushBlock(cachedBlock, transactions, validatorState, cumulativeBlockSize, emissionChange, currentDifficulty, std::move(rawBlock));
 
+        const auto previousBlockMedianSize = blockMedianSize;
         updateBlockMedianSize();
-        actualizePoolTransactionsLite(validatorState);
+        actualizePoolTransactionsLite(validatorState, previousBlockIndex, previousBlockMedianSize);
 
         ret = error::AddBlockErrorCode::ADDED_TO_MAIN;
         logger(Logging::DEBUGGING) << "Block " << blockStr << " added to main chain.";
+
+        pruneBlocks();
         if ((previousBlockIndex + 1) % 100 == 0) {
           logger(Logging::INFO) << "Block " << blockStr << " added to main chain";
         }
@@ -1249,25 +1149,70 @@ void Core::actualizePoolTransactions() {
   }
 }
 
-void Core::actualizePoolTransactionsLite(const TransactionValidatorState& validatorState) {
+void Core::actualizePoolTransactionsLite(const TransactionValidatorState& validatorState, uint32_t previousTopIndex,
+                                         size_t previousBlockMedianSize) {
   auto& pool = *transactionPool;
-  auto hashes = pool.getTransactionHashes();
 
-  TransactionValidatorState validator = validatorState;
+  /* The pool transactions were validated against the rules at the previous
+     height. If those rules changed with this block, check them all again. */
+  if (poolValidationRulesChanged(previousTopIndex, getTopBlockIndex())) {
+    auto hashes = pool.getTransactionHashes();
 
-  for (auto& hash : hashes) {
-    auto tx = pool.getTransaction(hash);
+    TransactionValidatorState validator = validatorState;
 
-    auto txState = extractSpentOutputs(tx);
+    for (auto& hash : hashes) {
+      auto tx = pool.getTransaction(hash);
 
-    if (hasIntersections(validatorState, txState) ||
-        tx.getTransactionBinaryArray().size() > getMaximumTransactionAllowedSize(blockMedianSize, currency) ||
-        !isTransactionValidForPool(tx, validator))
-    {
-      pool.removeTransaction(hash);
-      notifyObservers(makeDelTransactionMessage({ hash }, Messages::DeleteTransaction::Reason::NotActual));
+      auto txState = extractSpentOutputs(tx);
+
+      if (hasIntersections(validatorState, txState) ||
+          tx.getTransactionBinaryArray().size() > getMaximumTransactionAllowedSize(blockMedianSize, currency) ||
+          !isTransactionValidForPool(tx, validator))
+      {
+        pool.removeTransaction(hash);
+        notifyObservers(makeDelTransactionMessage({ hash }, Messages::DeleteTransaction::Reason::NotActual));
+      }
+    }
+
+    return;
+  }
+
+  /* Otherwise a pool transaction can only have become invalid by spending a
+     key image this block spent, or by no longer fitting the median */
+  auto hashes = pool.getTransactionHashesByKeyImages(validatorState);
+
+  /* The limit only gets tighter when the median shrinks */
+  if (blockMedianSize < previousBlockMedianSize) {
+    const auto maxTransactionSize = getMaximumTransactionAllowedSize(blockMedianSize, currency);
+
+    std::unordered_set<Crypto::Hash> conflicting(hashes.begin(), hashes.end());
+
+    for (const auto& hash : pool.getTransactionHashes()) {
+      if (conflicting.count(hash) == 0 && pool.getTransaction(hash).getTransactionBinaryArray().size() > maxTransactionSize) {
+        hashes.push_back(hash);
+      }
     }
   }
+
+  for (const auto& hash : hashes) {
+    pool.removeTransaction(hash);
+    notifyObservers(makeDelTransactionMessage({ hash }, Messages::DeleteTransaction::Reason::NotActual));
+  }
+}
+
+/* Whether a transaction accepted into the pool at previousTopIndex might be
+   judged differently by isTransactionValidForPool at topIndex. Key images
+   and the size limit are handled separately, and outputs only ever unlock
+   as the chain grows. */
+bool Core::poolValidationRulesChanged(uint32_t previousTopIndex, uint32_t topIndex) const {
+  const auto extraSizeLimitHeight = CryptoNote::parameters::MAX_EXTRA_SIZE_V2_HEIGHT + CryptoNote::parameters::CRYPTONOTE_MINED_MONEY_UNLOCK_WINDOW;
+
+  return Utilities::getMixinAllowableRange(previousTopIndex) != Utilities::getMixinAllowableRange(topIndex)
+      || (previousTopIndex >= extraSizeLimitHeight) != (topIndex >= extraSizeLimitHeight)
+      || (previousTopIndex >= CryptoNote::parameters::TRANSACTION_SIGNATURE_COUNT_VALIDATION_HEIGHT)
+           != (topIndex >= CryptoNote::parameters::TRANSACTION_SIGNATURE_COUNT_VALIDATION_HEIGHT)
+      || currency.defaultFusionDustThreshold(previousTopIndex) != currency.defaultFusionDustThreshold(topIndex)
+      || checkpoints.isInCheckpointZone(previousTopIndex + 1) != checkpoints.isInCheckpointZone(topIndex + 1);
 }
 
 void Core::switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain) {
@@ -1318,6 +1263,64 @@ std::error_code Core::addBlock(RawBlock&& rawBlock) {
   return addBlock(cachedBlock, std::move(rawBlock));
 }
 
+void Core::precalculateBlockLongHashes(const std::vector<CachedBlock>& cachedBlocks) {
+  if (!validationThreadPool) {
+    return;
+  }
+
+  std::vector<const CachedBlock*> pending;
+
+  /* Blocks which addBlock won't reject as orphans, so a peer can't make us
+     hash blocks which don't connect to anything */
+  std::unordered_set<Crypto::Hash> connected;
+
+  for (const auto& cachedBlock : cachedBlocks) {
+    if (pending.size() >= CryptoNote::VALIDATION_PRECALCULATE_MAX_BLOCKS) {
+      break;
+    }
+
+    const Crypto::Hash& previousBlockHash = cachedBlock.getBlock().previousBlockHash;
+
+    if (connected.count(previousBlockHash) == 0 && !hasBlock(previousBlockHash)) {
+      continue;
+    }
+
+    connected.insert(cachedBlock.getBlockHash());
+
+    /* addBlock only checks the proof of work outside of the checkpoint zone,
+       and not at all for blocks we already have */
+    if (checkpoints.isInCheckpointZone(cachedBlock.getBlockIndex()) || hasBlock(cachedBlock.getBlockHash())) {
+      continue;
+    }
+
+    pending.push_back(&cachedBlock);
+  }
+
+  /* Each job hashes a few blocks at once, which is quicker per block, but
+     only once there's enough blocks to keep every thread busy */
+  const size_t threadCount = validationThreadPool->threadCount();
+  const size_t blocksPerJob = std::clamp<size_t>((pending.size() + threadCount - 1) / threadCount, 1,
+                                                 Crypto::SLOW_HASH_MAX_WAYS);
+
+  std::vector<std::future<void>> jobs;
+
+  for (size_t start = 0; start < pending.size(); start += blocksPerJob) {
+    const size_t end = std::min(start + blocksPerJob, pending.size());
+
+    jobs.push_back(validationThreadPool->addJob([&pending, start, end]() {
+      CachedBlock::calculateBlockLongHashes({pending.begin() + start, pending.begin() + end});
+    }));
+  }
+
+  for (auto& job : jobs) {
+    /* A block we can't hash is rejected by addBlock as usual */
+    try {
+      job.get();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
 std::error_code Core::submitBlock(BinaryArray&& rawBlockTemplate) {
   throwIfNotInitialized();
 
@@ -1425,25 +1428,7 @@ bool Core::getGlobalIndexesForRange(
     {
         IBlockchainCache *mainChain = chainsLeaves[0];
 
-        std::vector<Crypto::Hash> transactionHashes;
-
-        for (const auto rawBlock : mainChain->getBlocksByHeight(startHeight, endHeight))
-        {
-            for (const auto transaction : rawBlock.transactions)
-            {
-                transactionHashes.push_back(getBinaryArrayHash(transaction));
-            }
-
-            BlockTemplate block;
-
-            fromBinaryArray(block, rawBlock.block);
-
-            transactionHashes.push_back(
-                getBinaryArrayHash(toBinaryArray(block.baseTransaction))
-            );
-        }
-
-        indexes = mainChain->getGlobalIndexes(transactionHashes);
+        indexes = mainChain->getGlobalIndexesForRange(startHeight, endHeight);
 
         return true;
     }
@@ -1818,6 +1803,29 @@ bool Core::extractTransactions(const std::vector<BinaryArray>& rawTransactions,
 
 std::error_code Core::validateTransaction(const CachedTransaction& cachedTransaction, TransactionValidatorState& state,
                                           IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex) {
+  std::vector<RingSignatureCheck> signatureChecks;
+
+  if (auto error = validateTransaction(cachedTransaction, state, cache, fee, blockIndex, &signatureChecks)) {
+    return error;
+  }
+
+  if (checkRingSignatures(signatureChecks) != signatureChecks.size()) {
+    return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+  }
+
+  for (const auto& check : signatureChecks) {
+    signatureCache.insert(check.signatureCacheKey);
+  }
+
+  return error::TransactionValidationError::VALIDATION_SUCCESS;
+}
+
+/* The ring signatures are not verified here, but appended to
+   deferredSignatureChecks in input order for the caller to verify with
+   checkRingSignatures() */
+std::error_code Core::validateTransaction(const CachedTransaction& cachedTransaction, TransactionValidatorState& state,
+                                          IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+                                          std::vector<RingSignatureCheck>* deferredSignatureChecks) {
   // TransactionValidatorState currentState;
   const auto& transaction = cachedTransaction.getTransaction();
 auto error = validateSemantic(transaction, fee, blockIndex);
@@ -1862,8 +1870,21 @@ auto error = validateSemantic(transaction, fee, blockIndex);
           return error::TransactionValidationError::INPUT_INVALID_SIGNATURES_COUNT;
         }
 
-        if (!Crypto::crypto_ops::checkRingSignature(cachedTransaction.getTransactionPrefixHash(), in.keyImage, outputKeys, transaction.signatures[inputIndex])) {
-          return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+        const auto signatureCacheKey = SignatureCache::getKey(
+          cachedTransaction.getTransactionPrefixHash(), in.keyImage, outputKeys, transaction.signatures[inputIndex]
+        );
+
+        if (signatureCache.contains(signatureCacheKey)) {
+          /* Already verified when the transaction entered the pool */
+        } else {
+          deferredSignatureChecks->push_back({
+            cachedTransaction.getTransactionHash(),
+            cachedTransaction.getTransactionPrefixHash(),
+            in.keyImage,
+            std::move(outputKeys),
+            &transaction.signatures[inputIndex],
+            signatureCacheKey
+          });
         }
       }
 
@@ -1878,6 +1899,73 @@ auto error = validateSemantic(transaction, fee, blockIndex);
   return error::TransactionValidationError::VALIDATION_SUCCESS;
 }
 
+/* Returns the index of the first check which failed, or checks.size() if
+   they all passed */
+size_t Core::checkRingSignatures(const std::vector<RingSignatureCheck>& checks) {
+  /* Checks [start, end) a batch at a time, returning the index of the first
+     failure, or end. Stops early once stop() is true. */
+  const auto checkRange = [&checks](size_t start, size_t end, const auto& stop) {
+    std::vector<Crypto::RingCheck> batch;
+
+    for (size_t batchStart = start; batchStart < end && !stop(batchStart); batchStart += RING_SIGNATURE_BATCH_SIZE) {
+      const size_t batchEnd = std::min(batchStart + RING_SIGNATURE_BATCH_SIZE, end);
+
+      batch.clear();
+
+      for (size_t i = batchStart; i < batchEnd; ++i) {
+        batch.push_back({&checks[i].transactionPrefixHash, &checks[i].keyImage, &checks[i].outputKeys, checks[i].signatures});
+      }
+
+      const std::vector<bool> results = Crypto::crypto_ops::checkRingSignatures({batch.data(), batch.size()});
+
+      const auto failed = std::find(results.begin(), results.end(), false);
+
+      if (failed != results.end()) {
+        return batchStart + std::distance(results.begin(), failed);
+      }
+    }
+
+    return end;
+  };
+
+  if (!validationThreadPool || checks.size() <= RING_SIGNATURE_BATCH_SIZE) {
+    return checkRange(0, checks.size(), [](size_t) { return false; });
+  }
+
+  /* Lowest index of a failed check seen so far. Workers skip anything above
+     it, since only the first failure in block order is reported. */
+  std::atomic<size_t> firstFailure(checks.size());
+
+  /* At least a full batch per thread, so the batches aren't split up too
+     finely to gain anything */
+  const size_t threadCount = std::min(validationThreadPool->threadCount(),
+                                      (checks.size() + RING_SIGNATURE_BATCH_SIZE - 1) / RING_SIGNATURE_BATCH_SIZE);
+  const size_t chunkSize = (checks.size() + threadCount - 1) / threadCount;
+
+  std::vector<std::future<void>> jobs;
+
+  for (size_t start = 0; start < checks.size(); start += chunkSize) {
+    const size_t end = std::min(start + chunkSize, checks.size());
+
+    jobs.push_back(validationThreadPool->addJob([&, start, end]() {
+      const size_t failed = checkRange(start, end, [&firstFailure](size_t i) { return i >= firstFailure; });
+
+      if (failed != end) {
+        size_t current = firstFailure;
+
+        while (failed < current && !firstFailure.compare_exchange_weak(current, failed)) {
+        }
+      }
+    }));
+  }
+
+  for (auto& job : jobs) {
+    job.get();
+  }
+
+  return firstFailure;
+}
+
 std::error_code Core::validateSemantic(const Transaction& transaction, uint64_t& fee, uint32_t blockIndex) {
   if (transaction.inputs.empty()) {
     return error::TransactionValidationError::EMPTY_INPUTS;
@@ -2115,6 +2203,18 @@ void Core::load() {
     logger(Logging::DEBUGGING) << "Blockchain storage and root segment are on the same height and chain";
   }
 
+  if (pruneDepth != 0) {
+    if (!mainChainStorage->canPruneBlocks()) {
+      logger(Logging::ERROR) << "Pruning was requested, but the blockchain storage can't be pruned";
+      throw std::runtime_error("Blockchain storage can't be pruned");
+    }
+
+    logger(Logging::INFO) << "Pruning blocks more than " << pruneDepth << " blocks deep, this may take a while the first time";
+
+    while (pruneBlocks()) {
+    }
+  }
+
   initialized = true;
 }
 
@@ -2127,6 +2227,7 @@ void Core::initRootSegment() {
   chainsStorage.push_back(std::move(cache));
 
   contextGroup.spawn(std::bind(&Core::transactionPoolCleaningProcedure, this));
+  contextGroup.spawn(std::bind(&Core::mainChainStorageCommittingProcedure, this));
 
   updateBlockMedianSize();
 
@@ -2137,14 +2238,116 @@ void Core::importBlocksFromStorage() {
   uint32_t commonIndex = findCommonRoot(*mainChainStorage, *chainsLeaves[0]);
   assert(commonIndex <= mainChainStorage->getBlockCount());
 
+  /* Pruned blocks are missing their transactions, pushing them would leave
+     the DB without their outputs and key images */
+  const uint32_t storagePrunedHeight = mainChainStorage->getPrunedHeight();
+
+  if (commonIndex + 1 < storagePrunedHeight) {
+    logger(Logging::ERROR) << "Blockchain storage is pruned up to block index " << storagePrunedHeight
+                           << ", but the DB needs blocks from index " << commonIndex + 1 << " imported." << std::endl
+                           << "The DB can't be rebuilt from a pruned blockchain storage, please launch the node with the option: --resync" << std::endl;
+    throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+  }
+
   cutSegment(*chainsLeaves[0], commonIndex + 1);
 
   auto previousBlockHash = getBlockHash(mainChainStorage->getBlockByIndex(commonIndex));
   auto blockCount = mainChainStorage->getBlockCount();
+
+  /* Deserializing and hashing doesn't depend on the previous block, so it is
+     done in parallel on the validation threads, ahead of the blocks being
+     pushed in order here. The storage is read from a single thread, since
+     not every IMainChainStorage can be read concurrently. */
+  const auto parseBlock = [this](RawBlock&& rawBlock) {
+    auto block = std::make_unique<ImportedBlock>();
+
+    block->rawBlock = std::move(rawBlock);
+    block->blockTemplate = extractBlockTemplate(block->rawBlock);
+    block->cachedBlock.emplace(block->blockTemplate);
+    block->cachedBlock->getBlockHash();
+
+    /* The storage's pruned height should have caught this, but a pruned
+       block must never make it into the DB */
+    if (block->rawBlock.transactions.size() != block->blockTemplate.transactionHashes.size()) {
+      logger(Logging::ERROR) << "Block " << block->cachedBlock->getBlockHash() << " in the blockchain storage has "
+                             << block->rawBlock.transactions.size() << " transactions, but should have "
+                             << block->blockTemplate.transactionHashes.size() << "." << std::endl
+                             << "The blockchain storage is pruned, please launch the node with the option: --resync" << std::endl;
+      throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+    }
+
+    if (!extractTransactions(block->rawBlock.transactions, block->transactions, block->cumulativeSize)) {
+      logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block " << block->cachedBlock->getBlockHash();
+      throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+    }
+
+    block->cumulativeSize += getObjectBinarySize(block->blockTemplate.baseTransaction);
+    block->spentOutputs = extractSpentOutputs(block->transactions);
+
+    for (const auto& transaction : block->transactions) {
+      transaction.getTransactionHash();
+      block->cumulativeFee += transaction.getTransactionFee();
+    }
+
+    return block;
+  };
+
+  using ParsedBlocks = std::vector<std::future<std::unique_ptr<ImportedBlock>>>;
+
+  std::unique_ptr<ThreadPool> readerThread;
+  /* Ranges being read, each resolving to its blocks being parsed */
+  std::deque<std::future<ParsedBlocks>> pendingRanges;
+  std::deque<std::future<std::unique_ptr<ImportedBlock>>> pendingBlocks;
+  uint32_t nextBlockToRead = commonIndex + 1;
+
+  if (validationThreadPool) {
+    readerThread = std::make_unique<ThreadPool>(1);
+  }
+
+  const auto readAhead = [&]() {
+    while (nextBlockToRead < blockCount && (pendingRanges.size() + 1) * IMPORT_READ_BATCH_SIZE <= IMPORT_PIPELINE_DEPTH) {
+      const uint32_t startIndex = nextBlockToRead;
+      const uint32_t endIndex = std::min(blockCount, startIndex + IMPORT_READ_BATCH_SIZE);
+      nextBlockToRead = endIndex;
+
+      pendingRanges.push_back(readerThread->addJob([this, startIndex, endIndex, parseBlock]() {
+        ParsedBlocks parsedBlocks;
+
+        for (auto& rawBlock : mainChainStorage->getBlocksByIndexRange(startIndex, endIndex)) {
+          parsedBlocks.push_back(validationThreadPool->addJob([rawBlock = std::move(rawBlock), parseBlock]() mutable {
+            return parseBlock(std::move(rawBlock));
+          }));
+        }
+
+        return parsedBlocks;
+      }));
+    }
+  };
+
   for (uint32_t i = commonIndex + 1; i < blockCount; ++i) {
-    RawBlock rawBlock = mainChainStorage->getBlockByIndex(i);
-    auto blockTemplate = extractBlockTemplate(rawBlock);
-    CachedBlock cachedBlock(blockTemplate);
+    std::unique_ptr<ImportedBlock> block;
+
+    if (readerThread) {
+      if (pendingBlocks.empty()) {
+        readAhead();
+
+        for (auto& parsedBlock : pendingRanges.front().get()) {
+          pendingBlocks.push_back(std::move(parsedBlock));
+        }
+
+        pendingRanges.pop_front();
+
+        readAhead();
+      }
+
+      block = pendingBlocks.front().get();
+      pendingBlocks.pop_front();
+    } else {
+      block = parseBlock(mainChainStorage->getBlockByIndex(i));
+    }
+
+    const auto& blockTemplate = block->blockTemplate;
+    const auto& cachedBlock = *block->cachedBlock;
 
     if (blockTemplate.previousBlockHash != previousBlockHash) {
       logger(Logging::ERROR) << "Local blockchain corruption detected. " << std::endl
@@ -2157,23 +2360,10 @@ void Core::importBlocksFromStorage() {
 
     previousBlockHash = cachedBlock.getBlockHash();
 
-    std::vector<CachedTransaction> transactions;
-    uint64_t cumulativeSize = 0;
-    if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize)) {
-      logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
-      throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
-    }
-
-    cumulativeSize += getObjectBinarySize(blockTemplate.baseTransaction);
-    TransactionValidatorState spentOutputs = extractSpentOutputs(transactions);
     auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
 
-    uint64_t cumulativeFee = std::accumulate(transactions.begin(), transactions.end(), UINT64_C(0), [] (uint64_t fee, const CachedTransaction& transaction) {
-      return fee + transaction.getTransactionFee();
-    });
-
-    int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, cumulativeSize, cumulativeFee);
-    chainsLeaves[0]->pushBlock(cachedBlock, transactions, spentOutputs, cumulativeSize, emissionChange, currentDifficulty, std::move(rawBlock));
+    int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, block->cumulativeSize, block->cumulativeFee);
+    chainsLeaves[0]->pushBlock(cachedBlock, block->transactions, block->spentOutputs, block->cumulativeSize, emissionChange, currentDifficulty, std::move(block->rawBlock));
 
     if (i % 1000 == 0) {
       logger(Logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1);
@@ -2191,6 +2381,43 @@ void Core::cutSegment(IBlockchainCache& segment, uint32_t startIndex) {
   segment.deleteChild(childCache.get());
 }
 
+IBlockchainCache* Core::getRootSegment() const {
+  IBlockchainCache* segment = chainsLeaves[0];
+  assert(segment != nullptr);
+
+  while (segment->getParent() != nullptr) {
+    segment = segment->getParent();
+  }
+
+  return segment;
+}
+
+bool Core::pruneBlocks() {
+  const uint32_t blockCount = chainsLeaves[0]->getTopBlockIndex() + 1;
+
+  if (pruneDepth == 0 || blockCount <= pruneDepth) {
+    return false;
+  }
+
+  IBlockchainCache* root = getRootSegment();
+
+  const uint32_t startIndex = root->getPrunedBlockCount();
+  const uint32_t endIndex = std::min({blockCount - pruneDepth, root->getTopBlockIndex() + 1,
+                                      startIndex + CryptoNote::DATABASE_PRUNE_BATCH_SIZE});
+
+  /* Wait for a few to be due, rather than pruning each block on its own */
+  if (endIndex < startIndex + CryptoNote::DATABASE_PRUNE_INTERVAL) {
+    return false;
+  }
+
+  /* The main chain storage goes first, so if we're interrupted, the root
+     segment still has these blocks down as whole, and they are pruned again */
+  mainChainStorage->pruneBlocks(startIndex, endIndex);
+  root->pruneRawBlocks(endIndex, endIndex - startIndex);
+
+  return true;
+}
+
 void Core::updateMainChainSet() {
   mainChainSet.clear();
   IBlockchainCache* chainPtr = chainsLeaves[0];
@@ -2444,9 +2671,7 @@ size_t Core::calculateCumulativeBlocksizeLimit(uint32_t height) const {
 
   assert(!chainsStorage.empty());
   assert(!chainsLeaves.empty());
-  // FIXME: skip gensis here?
-  auto sizes = chainsLeaves[0]->getLastBlocksSizes(currency.rewardBlocksWindow());
-  uint64_t median = Common::medianValue(sizes);
+  uint64_t median = chainsLeaves[0]->getLastBlocksSizesMedian(currency.rewardBlocksWindow(), chainsLeaves[0]->getTopBlockIndex(), skipGenesisBlock);
   if (median <= nextBlockGrantedFullRewardZone) {
     median = nextBlockGrantedFullRewardZone;
   }
@@ -2715,8 +2940,7 @@ BlockDetails Core::getBlockDetails(const Crypto::Hash& blockHash) const {
   uint64_t prevBlockGeneratedCoins = 0;
   blockDetails.sizeMedian = 0;
   if (blockDetails.index > 0) {
-    auto lastBlocksSizes = segment->getLastBlocksSizes(currency.rewardBlocksWindow(), blockDetails.index - 1, addGenesisBlock);
-    blockDetails.sizeMedian = Common::medianValue(lastBlocksSizes);
+    blockDetails.sizeMedian = segment->getLastBlocksSizesMedian(currency.rewardBlocksWindow(), blockDetails.index - 1, addGenesisBlock);
     prevBlockGeneratedCoins = segment->getAlreadyGeneratedCoins(blockDetails.index - 1);
   }
 
@@ -2965,6 +3189,24 @@ bool Core::hasTransaction(const Crypto::Hash& transactionHash) const {
   return findSegmentContainingTransaction(transactionHash) != nullptr || transactionPool->checkIfTransactionPresent(transactionHash);
 }
 
+/* Blocks pushed to the main chain storage may be held back to be written
+   together, commit them while we're otherwise idle */
+void Core::mainChainStorageCommittingProcedure() {
+  System::Timer timer(dispatcher);
+
+  try {
+    for (;;) {
+      timer.sleep(MAIN_CHAIN_STORAGE_COMMIT_INTERVAL);
+
+      mainChainStorage->commit();
+    }
+  } catch (System::InterruptedException&) {
+    logger(Logging::DEBUGGING) << "mainChainStorageCommittingProcedure has been interrupted";
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Error occurred while committing the blockchain storage: " << e.what();
+  }
+}
+
 void Core::transactionPoolCleaningProcedure() {
   System::Timer timer(dispatcher);
 
@@ -2987,9 +3229,9 @@ void Core::updateBlockMedianSize() {
 
   size_t nextBlockGrantedFullRewardZone = currency.blockGrantedFullRewardZoneByBlockVersion(upgradeManager->getBlockMajorVersion(mainChain->getTopBlockIndex() + 1));
 
-  auto lastBlockSizes = mainChain->getLastBlocksSizes(currency.rewardBlocksWindow());
+  auto lastBlocksSizesMedian = mainChain->getLastBlocksSizesMedian(currency.rewardBlocksWindow(), mainChain->getTopBlockIndex(), skipGenesisBlock);
 
-  blockMedianSize = std::max(Common::medianValue(lastBlockSizes), static_cast<uint64_t>(nextBlockGrantedFullRewardZone));
+  blockMedianSize = std::max(lastBlocksSizesMedian, static_cast<uint64_t>(nextBlockGrantedFullRewardZone));
 }
 
 uint64_t Core::get_current_blockchain_height() const
@@ -2998,6 +3240,24 @@ uint64_t Core::get_current_blockchain_height() const
   return mainChainStorage->getBlockCount();
 }
 
+uint64_t Core::getSignatureCacheHits() const {
+  return signatureCache.getHits();
+}
+
+uint64_t Core::getSignatureCacheMisses() const {
+  return signatureCache.getMisses();
+}
+
+uint64_t Core::getKeyOutputCacheHits() const {
+  throwIfNotInitialized();
+  return findIndexInChain(chainsLeaves[0], 0)->getKeyOutputCacheHits();
+}
+
+uint64_t Core::getKeyOutputCacheMisses() const {
+  throwIfNotInitialized();
+  return findIndexInChain(chainsLeaves[0], 0)->getKeyOutputCacheMisses();
+}
+
 std::time_t Core::getStartTime() const
 {
   return start_time;
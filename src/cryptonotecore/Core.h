@@ -23,18 +23,34 @@
 #include "IUpgradeManager.h"
 #include <Logging/LoggerMessage.h>
 #include "MessageQueue.h"
+#include "SignatureCache.h"
 #include "TransactionValidatiorState.h"
 
 #include <System/ContextGroup.h>
 
+#include <Utilities/ThreadPool.h>
+
 #include <WalletTypes.h>
 
 namespace CryptoNote {
 
+/* A ring signature check which has been deferred by validateTransaction, so
+   the signatures of a whole block can be verified together on the
+   validation thread pool once the cheap checks have passed */
+struct RingSignatureCheck {
+  Crypto::Hash transactionHash;
+  Crypto::Hash transactionPrefixHash;
+  Crypto::KeyImage keyImage;
+  std::vector<Crypto::PublicKey> outputKeys;
+  const std::vector<Crypto::Signature>* signatures;
+  Crypto::Hash signatureCacheKey;
+};
+
 class Core : public ICore, public ICoreInformation {
 public:
   Core(const Currency& currency, std::shared_ptr<Logging::ILogger> logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
-       std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainChainStorage);
+       std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainChainStorage,
+       uint32_t validationThreads, uint32_t pruneDepth);
   virtual ~Core();
 
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>&  messageQueue) override;
@@ -42,6 +58,7 @@ public:
 
   virtual uint32_t getTopBlockIndex() const override;
   virtual Crypto::Hash getTopBlockHash() const override;
+  virtual uint32_t getPrunedHeight() const override;
   virtual Crypto::Hash getBlockHashByIndex(uint32_t blockIndex) const override;
   virtual uint64_t getBlockTimestampByIndex(uint32_t blockIndex) const override;
 
@@ -87,6 +104,8 @@ public:
 
   virtual std::error_code submitBlock(BinaryArray&& rawBlockTemplate) override;
 
+  virtual void precalculateBlockLongHashes(const std::vector<CachedBlock>& cachedBlocks) override;
+
   virtual bool getTransactionGlobalIndexes(const Crypto::Hash& transactionHash, std::vector<uint32_t>& globalIndexes) const override;
   virtual bool getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_t>& globalIndexes, std::vector<Crypto::PublicKey>& publicKeys) const override;
 
@@ -129,6 +148,12 @@ public:
 
   virtual uint64_t get_current_blockchain_height() const;
 
+  uint64_t getSignatureCacheHits() const;
+  uint64_t getSignatureCacheMisses() const;
+
+  uint64_t getKeyOutputCacheHits() const;
+  uint64_t getKeyOutputCacheMisses() const;
+
 private:
   const Currency& currency;
   System::Dispatcher& dispatcher;
@@ -152,11 +177,25 @@ private:
 
   size_t blockMedianSize;
 
+  /* Verifies the ring signatures of incoming blocks. Null when running with
+     a single validation thread, in which case we verify inline. */
+  std::unique_ptr<ThreadPool> validationThreadPool;
+
+  /* Ring signatures already verified on the way into the pool */
+  SignatureCache signatureCache;
+
+  /* Blocks deeper than this below the top have their transactions dropped,
+     zero keeps every block whole */
+  const uint32_t pruneDepth;
+
   void throwIfNotInitialized() const;
   bool extractTransactions(const std::vector<BinaryArray>& rawTransactions, std::vector<CachedTransaction>& transactions, uint64_t& cumulativeSize);
 
   std::error_code validateSemantic(const Transaction& transaction, uint64_t& fee, uint32_t blockIndex);
   std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex);
+  std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+    std::vector<RingSignatureCheck>* deferredSignatureChecks);
+  size_t checkRingSignatures(const std::vector<RingSignatureCheck>& checks);
 
   uint32_t findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds) const;
   std::vector<Crypto::Hash> getBlockHashes(uint32_t startBlockIndex, uint32_t maxCount) const;
@@ -215,9 +254,11 @@ private:
   void copyTransactionsToPool(IBlockchainCache* alt);
 
   void actualizePoolTransactions();
-  void actualizePoolTransactionsLite(const TransactionValidatorState& validatorState); //Checks pool txs only for double spend.
+  void actualizePoolTransactionsLite(const TransactionValidatorState& validatorState, uint32_t previousTopIndex, size_t previousBlockMedianSize); //Checks pool txs only for double spend.
+  bool poolValidationRulesChanged(uint32_t previousTopIndex, uint32_t topIndex) const;
 
   void transactionPoolCleaningProcedure();
+  void mainChainStorageCommittingProcedure();
   void updateBlockMedianSize();
   bool addTransactionToPool(CachedTransaction&& cachedTransaction);
   bool isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState);
@@ -228,15 +269,10 @@ private:
 
   void switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain);
 
-  static WalletTypes::RawCoinbaseTransaction getRawCoinbaseTransaction(
-    const CryptoNote::Transaction &t);
-
-  static WalletTypes::RawTransaction getRawTransaction(
-    const std::vector<uint8_t> &rawTX);
-
-  static Crypto::PublicKey getPubKeyFromExtra(const std::vector<uint8_t> &extra);
-
-  static std::string getPaymentIDFromExtra(const std::vector<uint8_t> &extra);
+  IBlockchainCache* getRootSegment() const;
+  /* Prunes the next batch of blocks which are deep enough, returning false
+     if there were too few to bother with */
+  bool pruneBlocks();
 };
 
 }
@@ -17,9 +17,13 @@
 
 #include "DBUtils.h"
 
+#include "ICoreDefinitions.h"
+#include "WalletTypesSerialization.h"
+
 namespace {
   const std::string RAW_BLOCK_NAME = "raw_block";
   const std::string RAW_TXS_NAME = "raw_txs";
+  const std::string WALLET_BLOCK_INFO_NAME = "wallet_block_info";
 }
 
 namespace CryptoNote {
@@ -42,5 +46,24 @@ namespace DB {
     serializer(value.block, RAW_BLOCK_NAME);
     serializer(value.transactions, RAW_TXS_NAME);
   }
+
+  /* Served to every syncing wallet, so it's stored in the plain binary
+     format rather than the (much larger, and slower to parse) key/value one */
+  std::string serialize(const WalletTypes::WalletBlockInfo& value, const std::string& name) {
+    std::stringstream ss;
+    Common::StdOutputStream stream(ss);
+    CryptoNote::BinaryOutputStreamSerializer serializer(stream);
+
+    serializer(const_cast<WalletTypes::WalletBlockInfo&>(value), WALLET_BLOCK_INFO_NAME);
+
+    return ss.str();
+  }
+
+  void deserialize(const std::string& serialized, WalletTypes::WalletBlockInfo& value, const std::string& name) {
+    std::stringstream ss(serialized);
+    Common::StdInputStream stream(ss);
+    CryptoNote::BinaryInputStreamSerializer serializer(stream);
+    serializer(value, WALLET_BLOCK_INFO_NAME);
+  }
 }
 }
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <cassert>
+#include <cstring>
 #include <string>
 #include <sstream>
 
@@ -28,6 +30,8 @@
 #include "Common/StdInputStream.h"
 #include "Serialization/KVBinaryInputStreamSerializer.h"
 
+#include <WalletTypes.h>
+
 namespace CryptoNote {
 namespace DB {
   const std::string BLOCK_INDEX_TO_KEY_IMAGE_PREFIX = "0";
@@ -61,6 +65,10 @@ namespace DB {
 
   const std::string KEY_OUTPUT_KEY_PREFIX = "j";
 
+  const std::string BLOCK_INDEX_TO_WALLET_BLOCK_INFO_PREFIX = "k";
+
+  const std::string BLOCK_INDEX_TO_GLOBAL_INDEXES_PREFIX = "l";
+
   template <class Value>
   std::string serialize(const Value& value, const std::string& name) {
     CryptoNote::KVBinaryOutputStreamSerializer serializer;
@@ -74,15 +82,66 @@ namespace DB {
   }
 
   std::string serialize(const RawBlock& value, const std::string& name);
+  std::string serialize(const WalletTypes::WalletBlockInfo& value, const std::string& name);
 
-  template <class Key, class Value>
-  std::pair<std::string, std::string> serialize(const std::string& keyPrefix, const Key& key, const Value& value) {
-    return{ DB::serialize(std::make_pair(keyPrefix, key), keyPrefix), DB::serialize(value, keyPrefix) };
+  /* Keys are the one byte prefix followed by the key's fields, each fixed
+     width and big endian, so keys sort by prefix, then numerically by
+     height/amount/index. They're written straight into a stack buffer. */
+  const size_t MAX_KEY_SIZE = 1 + sizeof(Crypto::Hash) + sizeof(uint64_t);
+
+  inline char* encodeKey(char* out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      *out++ = static_cast<char>(value >> shift);
+    }
+
+    return out;
+  }
+
+  inline char* encodeKey(char* out, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      *out++ = static_cast<char>(value >> shift);
+    }
+
+    return out;
+  }
+
+  inline char* encodeKey(char* out, const Crypto::Hash& value) {
+    std::memcpy(out, value.data, sizeof(value.data));
+    return out + sizeof(value.data);
+  }
+
+  inline char* encodeKey(char* out, const Crypto::KeyImage& value) {
+    std::memcpy(out, value.data, sizeof(value.data));
+    return out + sizeof(value.data);
+  }
+
+  template <class First, class Second>
+  char* encodeKey(char* out, const std::pair<First, Second>& value) {
+    return encodeKey(encodeKey(out, value.first), value.second);
+  }
+
+  /* Named keys, such as LAST_BLOCK_INDEX_KEY. They never have the same
+     length as a fixed width key with the same prefix. */
+  inline std::string serializeKey(const std::string& keyPrefix, const std::string& key) {
+    return keyPrefix + key;
   }
 
   template <class Key>
   std::string serializeKey(const std::string& keyPrefix, const Key& key) {
-    return DB::serialize(std::make_pair(keyPrefix, key), keyPrefix);
+    assert(keyPrefix.size() == 1);
+
+    char buffer[MAX_KEY_SIZE];
+    buffer[0] = keyPrefix[0];
+
+    const char* end = encodeKey(buffer + 1, key);
+    assert(end <= buffer + MAX_KEY_SIZE);
+
+    return std::string(buffer, static_cast<size_t>(end - buffer));
+  }
+
+  template <class Key, class Value>
+  std::pair<std::string, std::string> serialize(const std::string& keyPrefix, const Key& key, const Value& value) {
+    return{ DB::serializeKey(keyPrefix, key), DB::serialize(value, keyPrefix) };
   }
 
   template <class Value>
@@ -94,10 +153,11 @@ namespace DB {
   }
 
   void deserialize(const std::string& serialized, RawBlock& value, const std::string& name);
+  void deserialize(const std::string& serialized, WalletTypes::WalletBlockInfo& value, const std::string& name);
 
   template <class Key, class Value>
   void serializeKeys(std::vector<std::string>& rawKeys, const std::string keyPrefix, const std::unordered_map<Key, Value>& map) {
-    for (const std::pair<Key, Value>& kv : map) {
+    for (const auto& kv : map) {
       rawKeys.emplace_back(DB::serializeKey(keyPrefix, kv.first));
     }
   }
@@ -8,9 +8,11 @@
 
 #include <ctime>
 #include <cstdlib>
+#include <cstring>
 
 #include <boost/iterator/iterator_facade.hpp>
 
+#include <Common/Math.h>
 #include <Common/ShuffleGenerator.h>
 
 #include "BlockchainUtils.h"
@@ -371,6 +373,8 @@ void cutTail(std::deque<CachedBlockInfo>& cache, size_t count) {
 }
 
 const std::string DB_VERSION_KEY = "db_scheme_version";
+const std::string SPENT_KEY_IMAGES_FILTER_KEY = "spent_key_images_filter";
+const std::string PRUNED_BLOCK_COUNT_KEY = "pruned_block_count";
 
 class DatabaseVersionReadBatch: public IReadBatch {
 public:
@@ -416,7 +420,97 @@ private:
   uint32_t schemeVersion;
 };
 
-const uint32_t CURRENT_DB_SCHEME_VERSION = 2;
+class SpentKeyImagesFilterReadBatch: public IReadBatch {
+public:
+  virtual ~SpentKeyImagesFilterReadBatch() {}
+
+  virtual std::vector<std::string> getRawKeys() const override {
+    return {SPENT_KEY_IMAGES_FILTER_KEY};
+  }
+
+  virtual void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override {
+    assert(values.size() == 1);
+    assert(resultStates.size() == values.size());
+
+    if (!resultStates[0]) {
+      return;
+    }
+
+    data = values[0];
+  }
+
+  const boost::optional<std::string>& getData() const {
+    return data;
+  }
+
+private:
+  boost::optional<std::string> data;
+};
+
+class SpentKeyImagesFilterWriteBatch: public IWriteBatch {
+public:
+  SpentKeyImagesFilterWriteBatch(std::string data): data(std::move(data)) {}
+  virtual ~SpentKeyImagesFilterWriteBatch() {}
+
+  virtual std::vector<std::pair<std::string, std::string> > extractRawDataToInsert() override {
+    return {make_pair(SPENT_KEY_IMAGES_FILTER_KEY, std::move(data))};
+  }
+
+  virtual std::vector<std::string> extractRawKeysToRemove() override {
+    return {};
+  }
+
+private:
+  std::string data;
+};
+
+class PrunedBlockCountReadBatch: public IReadBatch {
+public:
+  virtual ~PrunedBlockCountReadBatch() {}
+
+  virtual std::vector<std::string> getRawKeys() const override {
+    return {PRUNED_BLOCK_COUNT_KEY};
+  }
+
+  virtual void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override {
+    assert(values.size() == 1);
+    assert(resultStates.size() == values.size());
+
+    if (!resultStates[0]) {
+      return;
+    }
+
+    count = static_cast<uint32_t>(std::stoul(values[0]));
+  }
+
+  uint32_t getPrunedBlockCount() const {
+    return count;
+  }
+
+private:
+  uint32_t count = 0;
+};
+
+class PrunedBlockCountWriteBatch: public IWriteBatch {
+public:
+  PrunedBlockCountWriteBatch(uint32_t count): count(count) {}
+  virtual ~PrunedBlockCountWriteBatch() {}
+
+  virtual std::vector<std::pair<std::string, std::string> > extractRawDataToInsert() override {
+    return {make_pair(PRUNED_BLOCK_COUNT_KEY, std::to_string(count))};
+  }
+
+  virtual std::vector<std::string> extractRawKeysToRemove() override {
+    return {};
+  }
+
+private:
+  uint32_t count;
+};
+
+/* 3 - fixed width, big endian keys. Older databases are destroyed and
+   rebuilt from the main chain storage on startup, see checkDBSchemeVersion() */
+const uint32_t CURRENT_DB_SCHEME_VERSION = 3;
 
 }
 
@@ -426,8 +520,10 @@ struct DatabaseBlockchainCache::ExtendedPushedBlockInfo {
 };
 
 
-DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, std::shared_ptr<Logging::ILogger> _logger)
-    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache") {
+DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, std::shared_ptr<Logging::ILogger> _logger,
+                                                 size_t keyOutputCacheSize)
+    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache"),
+      blockSizesWindow(curr.rewardBlocksWindow()), keyOutputCache(keyOutputCacheSize) {
   DatabaseVersionReadBatch readBatch;
   auto ec = database.read(readBatch);
   if (ec) {
@@ -451,6 +547,37 @@ DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase
     logger(Logging::DEBUGGING) << "top block index is nill, add genesis block";
     addGenesisBlock(CachedBlock (currency.genesisBlock()));
   }
+
+  PrunedBlockCountReadBatch prunedReadBatch;
+  ec = database.read(prunedReadBatch);
+  if (ec) {
+    throw std::system_error(ec);
+  }
+
+  prunedBlockCount = prunedReadBatch.getPrunedBlockCount();
+
+  loadTimestampIndex();
+}
+
+void DatabaseBlockchainCache::loadTimestampIndex() {
+  const uint32_t topIndex = getTopBlockIndex();
+  const uint32_t step = 1000;
+
+  for (uint32_t index = 0; index <= topIndex; index += step) {
+    BlockchainReadBatch batch;
+
+    const uint32_t end = std::min(topIndex + 1, index + step);
+    for (uint32_t blockIndex = index; blockIndex < end; ++blockIndex) {
+      batch.requestCachedBlock(blockIndex);
+    }
+
+    auto result = readDatabase(batch);
+    for (uint32_t blockIndex = index; blockIndex < end; ++blockIndex) {
+      timestampIndex.push(result.getCachedBlocks().at(blockIndex).timestamp);
+    }
+  }
+
+  logger(Logging::DEBUGGING) << "Loaded timestamps of " << timestampIndex.getBlockCount() << " blocks";
 }
 
 bool DatabaseBlockchainCache::checkDBSchemeVersion(IDataBase& database, std::shared_ptr<Logging::ILogger> _logger) {
@@ -467,7 +594,7 @@ bool DatabaseBlockchainCache::checkDBSchemeVersion(IDataBase& database, std::sha
     //DB scheme version not found. Looks like it was just created.
     return true;
   } else if (*version < CURRENT_DB_SCHEME_VERSION) {
-    logger(Logging::WARNING) << "DB scheme version is less than expected. Expected version " << CURRENT_DB_SCHEME_VERSION << ". Actual version " << *version << ". DB will be destroyed and recreated from blocks.bin file.";
+    logger(Logging::WARNING) << "DB scheme version is less than expected. Expected version " << CURRENT_DB_SCHEME_VERSION << ". Actual version " << *version << ". DB will be destroyed and rebuilt from the main chain storage, this may take a while.";
     return false;
   } else if (*version > CURRENT_DB_SCHEME_VERSION) {
     logger(Logging::ERROR) << "DB scheme version is greater than expected. Expected version " << CURRENT_DB_SCHEME_VERSION << ". Actual version " << *version << ". Please update your software.";
@@ -515,6 +642,12 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
   assert(splitBlockIndex <= getTopBlockIndex());
   logger(Logging::DEBUGGING) << "split at index " << splitBlockIndex << " started, top block index: " << getTopBlockIndex();
 
+  /* The blocks would be moved to the new segment without their transactions */
+  if (splitBlockIndex < prunedBlockCount) {
+    logger(Logging::ERROR) << "Can't split at index " << splitBlockIndex << ", blocks below " << prunedBlockCount << " are pruned";
+    throw std::runtime_error("Can't split below the pruned block count, resync to remove pruned blocks");
+  }
+
   auto cache = blockchainCacheFactory.createBlockchainCache(currency, this, splitBlockIndex);
 
   using DeleteBlockInfo = std::tuple<uint32_t, Crypto::Hash, TransactionValidatorState, uint64_t>;
@@ -538,7 +671,8 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
     auto& validatorState = std::get<2>(*it);
     uint64_t timestamp = std::get<3>(*it);
 
-    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex);
+    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex).removeWalletBlockInfo(blockIndex);
+    writeBatch.removeGlobalIndexes(blockIndex);
     requestDeleteSpentOutputs(writeBatch,
                               blockIndex,
                               validatorState);
@@ -569,12 +703,23 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
   logger(Logging::DEBUGGING) << "Performing delete operations";
   // all data and indexes are now copied, no errors detected, can now erase data from database
   auto err = database.write(writeBatch);
+  if (!err) {
+    /* A split is a reorg or rewind, don't hold it back with blocks that
+       are being committed together */
+    err = database.flush();
+  }
+
   if (err) {
     logger(Logging::ERROR) << "split write failed, " << err.message();
     throw std::runtime_error(err.message());
   }
 
   cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
+  blockSizesWindowFilled = false;
+
+  for (auto it = deletingBlocks.rbegin(); it != deletingBlocks.rend(); ++it) {
+    timestampIndex.pop(std::get<3>(*it));
+  }
 
   children.push_back(cache.get());
   logger(Logging::TRACE) << "Delete successfull";
@@ -705,6 +850,8 @@ void DatabaseBlockchainCache::requestDeleteKeyOutputsAmount(BlockchainWriteBatch
   writeBatch.removeKeyOutputGlobalIndexes(amount, outputsCount - boundary, boundary);
   for (GlobalOutputIndex index = boundary; index < outputsCount; ++index) {
     writeBatch.removeKeyOutputInfo(amount, index);
+    // the global index will be reused by the next output of this amount
+    keyOutputCache.erase(std::make_pair(amount, index));
   }
 
   updateKeyOutputCount(amount, boundary - outputsCount);
@@ -731,10 +878,11 @@ void DatabaseBlockchainCache::requestRemoveTimestamp(BlockchainWriteBatch& batch
   }
 }
 
-void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTransaction,
-                                              uint32_t blockIndex,
-                                              uint16_t transactionBlockIndex,
-                                              BlockchainWriteBatch& batch) {
+// returns the global indexes given to the transaction's outputs
+TransactionGlobalIndexes DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTransaction,
+                                                                  uint32_t blockIndex,
+                                                                  uint16_t transactionBlockIndex,
+                                                                  BlockchainWriteBatch& batch) {
 
   logger(Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash();
   const auto& tx = cachedTransaction.getTransaction();
@@ -803,6 +951,8 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
   batch.insertCachedTransaction(transactionCacheInfo, getCachedTransactionsCount() + 1);
   transactionsCount = *transactionsCount + 1;
   logger(Logging::DEBUGGING) << "push transaction with hash " << cachedTransaction.getTransactionHash() << " finished";
+
+  return {transactionCacheInfo.transactionHash, transactionCacheInfo.globalIndexes};
 }
 
 uint32_t DatabaseBlockchainCache::updateKeyOutputCount(Amount amount, int32_t diff) const {
@@ -898,14 +1048,21 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
 
   batch.insertCachedBlock(blockInfo, getTopBlockIndex() + 1, txHashes);
   batch.insertRawBlock(getTopBlockIndex() + 1, std::move(rawBlock));
+  batch.insertWalletBlockInfo(getTopBlockIndex() + 1,
+                              Utils::getWalletBlockInfo(getTopBlockIndex() + 1, cachedBlock, cachedBaseTransaction, cachedTransactions));
+
+  std::vector<TransactionGlobalIndexes> globalIndexes;
+  globalIndexes.reserve(cachedTransactions.size() + 1);
 
   auto transactionIndex = 0;
-  pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch);
+  globalIndexes.push_back(pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch));
 
   for (const auto& transaction: cachedTransactions) {
-    pushTransaction(transaction, getTopBlockIndex() + 1, transactionIndex++, batch);
+    globalIndexes.push_back(pushTransaction(transaction, getTopBlockIndex() + 1, transactionIndex++, batch));
   }
 
+  batch.insertGlobalIndexes(getTopBlockIndex() + 1, globalIndexes);
+
   auto closestBlockIndexDb = requestClosestBlockIndexByTimestamp(roundToMidnight(cachedBlock.getBlock().timestamp), database);
   if (!closestBlockIndexDb.second) {
     logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash() << " request closest block index by timestamp failed";
@@ -928,10 +1085,27 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   topBlockHash = cachedBlock.getBlockHash();
   logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
 
+  if (spentKeyImagesFilter) {
+    for (const auto& keyImage: validatorState.spentKeyImages) {
+      spentKeyImagesFilter->insert(keyImage);
+    }
+
+    // past capacity the false positives climb quickly, so rebuild it with room to grow
+    if (spentKeyImagesFilter->getCount() > spentKeyImagesFilter->getCapacity()) {
+      buildSpentKeyImagesFilter(spentKeyImagesFilter->getCount() * 2);
+    }
+  }
+
   unitsCache.push_back(blockInfo);
   if (unitsCache.size() > unitsCacheSize) {
     unitsCache.pop_front();
   }
+
+  timestampIndex.push(blockInfo.timestamp);
+
+  if (blockSizesWindowFilled) {
+    blockSizesWindow.push(blockInfo.blockSize);
+  }
 }
 
 PushedBlockInfo DatabaseBlockchainCache::getPushedBlockInfo(uint32_t blockIndex) const {
@@ -939,6 +1113,11 @@ PushedBlockInfo DatabaseBlockchainCache::getPushedBlockInfo(uint32_t blockIndex)
 }
 
 bool DatabaseBlockchainCache::checkIfSpent(const Crypto::KeyImage& keyImage, uint32_t blockIndex) const {
+  // almost every lookup is for an unspent key image, the filter answers those without the database
+  if (spentKeyImagesFilter && !spentKeyImagesFilter->mayContain(keyImage)) {
+    return false;
+  }
+
   auto batch = BlockchainReadBatch().requestBlockIndexBySpentKeyImage(keyImage);
   auto res = database.read(batch);
   if (res) {
@@ -1131,6 +1310,28 @@ std::vector<uint64_t> DatabaseBlockchainCache::getLastBlocksSizes(size_t count,
   return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo& cb) { return cb.blockSize; });
 }
 
+uint64_t DatabaseBlockchainCache::getLastBlocksSizesMedian(size_t count, uint32_t blockIndex,
+                                                           UseGenesis useGenesis) const {
+  // the rolling window always includes genesis, so it only answers for the top block
+  // when genesis is either wanted or already out of the window
+  if (blockIndex == getTopBlockIndex() && count == blockSizesWindow.getCapacity() &&
+      (useGenesis || blockIndex >= count)) {
+    if (!blockSizesWindowFilled) {
+      blockSizesWindow.clear();
+      for (auto size: getLastBlocksSizes(count, blockIndex, UseGenesis{true})) {
+        blockSizesWindow.push(size);
+      }
+
+      blockSizesWindowFilled = true;
+    }
+
+    return blockSizesWindow.median();
+  }
+
+  auto sizes = getLastBlocksSizes(count, blockIndex, useGenesis);
+  return Common::medianValue(sizes);
+}
+
 std::vector<uint64_t> DatabaseBlockchainCache::getLastCumulativeDifficulties(size_t count, uint32_t blockIndex,
                                                                                UseGenesis useGenesis) const {
   return getLastUnits(count, blockIndex, useGenesis,
@@ -1147,9 +1348,26 @@ uint64_t DatabaseBlockchainCache::getDifficultyForNextBlock() const {
 uint64_t DatabaseBlockchainCache::getDifficultyForNextBlock(uint32_t blockIndex) const {
   assert(blockIndex <= getTopBlockIndex());
   uint8_t nextBlockMajorVersion = getBlockMajorVersionForHeight(blockIndex+1);
-  auto timestamps = getLastTimestamps(currency.difficultyBlocksCountByBlockVersion(nextBlockMajorVersion, blockIndex), blockIndex, UseGenesis{false});
-  auto commulativeDifficulties =
-      getLastCumulativeDifficulties(currency.difficultyBlocksCountByBlockVersion(nextBlockMajorVersion, blockIndex), blockIndex, UseGenesis{false});
+  const size_t count = currency.difficultyBlocksCountByBlockVersion(nextBlockMajorVersion, blockIndex);
+
+  std::vector<uint64_t> timestamps;
+  std::vector<uint64_t> commulativeDifficulties;
+
+  // next block template: the whole difficulty window is in the tail of units cache,
+  // read both inputs in one pass without going through getLastUnits
+  if (blockIndex == getTopBlockIndex() && count <= unitsCache.size() && blockIndex >= count) {
+    timestamps.reserve(count);
+    commulativeDifficulties.reserve(count);
+
+    for (auto it = unitsCache.end() - count; it != unitsCache.end(); ++it) {
+      timestamps.push_back(it->timestamp);
+      commulativeDifficulties.push_back(it->cumulativeDifficulty);
+    }
+  } else {
+    timestamps = getLastTimestamps(count, blockIndex, UseGenesis{false});
+    commulativeDifficulties = getLastCumulativeDifficulties(count, blockIndex, UseGenesis{false});
+  }
+
   return currency.getNextDifficulty(nextBlockMajorVersion, blockIndex, std::move(timestamps), std::move(commulativeDifficulties));
 }
 
@@ -1359,45 +1577,31 @@ size_t DatabaseBlockchainCache::getKeyOutputsCountForAmount(uint64_t amount, uin
 
 std::tuple<bool, uint64_t> DatabaseBlockchainCache::getBlockHeightForTimestamp(uint64_t timestamp) const
 {
-    const auto midnight = roundToMidnight(timestamp);
+    /* From the start of the day, as when this was looked up by day, which
+       leaves a margin for blocks whose timestamps are behind the clocks of
+       the wallets asking */
+    const uint32_t blockIndex = timestampIndex.getLowerBound(roundToMidnight(timestamp));
 
-    const auto [blockHeight, success] = requestClosestBlockIndexByTimestamp(midnight, database);
-
-    /* Failed to read from DB */
-    if (!success)
-    {
-        logger(Logging::DEBUGGING) << "getTimestampLowerBoundBlockIndex failed: failed to read database";
-        throw std::runtime_error("Couldn't get closest to timestamp block index");
-    }
-
-    /* Failed to find the block height with this timestamp */
-    if (!blockHeight)
+    /* No block this recent yet */
+    if (blockIndex == timestampIndex.getBlockCount())
     {
         return {false, 0};
     }
 
-    return {true, *blockHeight};
+    return {true, blockIndex};
 }
 
 uint32_t DatabaseBlockchainCache::getTimestampLowerBoundBlockIndex(uint64_t timestamp) const {
-  auto midnight = roundToMidnight(timestamp);
-
-  while (midnight > 0) {
-    auto dbRes = requestClosestBlockIndexByTimestamp(midnight, database);
-    if (!dbRes.second) {
-      logger(Logging::DEBUGGING) << "getTimestampLowerBoundBlockIndex failed: failed to read database";
-      throw std::runtime_error("Couldn't get closest to timestamp block index");
-    }
+  // the first block of the day, as when this was looked up by day
+  const uint32_t blockIndex = timestampIndex.getLowerBound(roundToMidnight(timestamp));
 
-    if (!dbRes.first) {
-      midnight -= 60 * 60 * 24;
-      continue;
-    }
-
-    return *dbRes.first;
+  if (blockIndex < timestampIndex.getBlockCount()) {
+    return blockIndex;
   }
 
-  return 0;
+  // none that recent, so the first block of the latest day with blocks, just as
+  // the lookup by day walked back to it
+  return timestampIndex.getLowerBound(roundToMidnight(timestampIndex.getMaxTimestamp()));
 }
 
 bool DatabaseBlockchainCache::getTransactionGlobalIndexes(const Crypto::Hash& transactionHash,
@@ -1435,9 +1639,120 @@ size_t DatabaseBlockchainCache::getChildCount() const {
 }
 
 void DatabaseBlockchainCache::save() {
+  saveSpentKeyImagesFilter();
+
+  auto error = database.flush();
+  if (error) {
+    logger(Logging::ERROR) << "Failed to commit pending writes: " << error.message();
+  }
 }
 
 void DatabaseBlockchainCache::load() {
+  loadSpentKeyImagesFilter();
+}
+
+/*
+ * The filter is stored along with the top block it was saved at. It can only be used if that
+ * block is still in the chain, in which case key images of the blocks pushed since (e.g. the
+ * daemon was killed before saving) are added to it. Otherwise it is rebuilt from the database.
+ * Blocks removed by split leave their key images in the filter, which is harmless.
+ */
+void DatabaseBlockchainCache::loadSpentKeyImagesFilter() {
+  const uint32_t topIndex = getTopBlockIndex();
+  size_t capacity = SPENT_KEY_IMAGES_FILTER_MIN_CAPACITY;
+
+  SpentKeyImagesFilterReadBatch readBatch;
+  auto error = database.read(readBatch);
+  if (error) {
+    logger(Logging::WARNING) << "Failed to read spent key images filter: " << error.message();
+  } else if (readBatch.getData()) {
+    const std::string& data = *readBatch.getData();
+
+    uint32_t filterTopIndex;
+    Crypto::Hash filterTopHash;
+    const size_t headerSize = sizeof(filterTopIndex) + sizeof(filterTopHash);
+
+    auto filter = std::make_unique<SpentKeyImageFilter>(0);
+
+    if (data.size() > headerSize && filter->fromBinary(data.substr(headerSize))) {
+      std::memcpy(&filterTopIndex, data.data(), sizeof(filterTopIndex));
+      std::memcpy(&filterTopHash, data.data() + sizeof(filterTopIndex), sizeof(filterTopHash));
+
+      capacity = std::max(capacity, filter->getCount() * 2);
+
+      if (filterTopIndex <= topIndex && getBlockHash(filterTopIndex) == filterTopHash &&
+          filter->getCount() <= filter->getCapacity()) {
+        addSpentKeyImagesToFilter(*filter, filterTopIndex + 1);
+        spentKeyImagesFilter = std::move(filter);
+
+        logger(Logging::DEBUGGING) << "Loaded spent key images filter with " << spentKeyImagesFilter->getCount() << " key images";
+        return;
+      }
+    }
+  }
+
+  buildSpentKeyImagesFilter(capacity);
+}
+
+/*
+ * Builds the filter from the key images of every block, replacing the current one once it's
+ * done, so lookups keep using the old one meanwhile.
+ */
+void DatabaseBlockchainCache::buildSpentKeyImagesFilter(size_t capacity) {
+  logger(Logging::INFO) << "Building spent key images filter, this may take a while...";
+
+  auto filter = std::make_unique<SpentKeyImageFilter>(capacity);
+  addSpentKeyImagesToFilter(*filter, 0);
+
+  if (filter->getCount() > filter->getCapacity()) {
+    filter = std::make_unique<SpentKeyImageFilter>(filter->getCount() * 2);
+    addSpentKeyImagesToFilter(*filter, 0);
+  }
+
+  spentKeyImagesFilter = std::move(filter);
+
+  logger(Logging::INFO) << "Spent key images filter built, " << spentKeyImagesFilter->getCount() << " key images";
+}
+
+void DatabaseBlockchainCache::saveSpentKeyImagesFilter() {
+  if (!spentKeyImagesFilter) {
+    return;
+  }
+
+  const uint32_t topIndex = getTopBlockIndex();
+  const Crypto::Hash topHash = getTopBlockHash();
+
+  std::string data(sizeof(topIndex) + sizeof(topHash), '\0');
+  std::memcpy(&data[0], &topIndex, sizeof(topIndex));
+  std::memcpy(&data[sizeof(topIndex)], &topHash, sizeof(topHash));
+  data += spentKeyImagesFilter->toBinary();
+
+  SpentKeyImagesFilterWriteBatch writeBatch(std::move(data));
+  auto error = database.write(writeBatch);
+  if (error) {
+    logger(Logging::WARNING) << "Failed to save spent key images filter: " << error.message();
+  }
+}
+
+void DatabaseBlockchainCache::addSpentKeyImagesToFilter(SpentKeyImageFilter& filter, uint32_t startIndex) const {
+  const uint32_t topIndex = getTopBlockIndex();
+  const uint32_t step = 1000;
+
+  for (uint32_t index = startIndex; index <= topIndex; index += step) {
+    BlockchainReadBatch batch;
+
+    const uint32_t end = std::min(topIndex + 1, index + step);
+    for (uint32_t blockIndex = index; blockIndex < end; ++blockIndex) {
+      batch.requestSpentKeyImagesByBlock(blockIndex);
+    }
+
+    auto result = readDatabase(batch);
+    for (const auto& block: result.getSpentKeyImagesByBlock()) {
+      for (const auto& keyImage: block.second) {
+        filter.insert(keyImage);
+      }
+    }
+  }
 }
 
 std::vector<BinaryArray>
@@ -1492,8 +1807,12 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
     if (transactionIt->second.transactionIndex == 0) {
       auto block = fromBinaryArray<BlockTemplate>(blockIt->second.block);
       foundTransactions.emplace_back(toBinaryArray(block.baseTransaction));
+    } else if (blockIt->second.transactions.size() < transactionIt->second.transactionIndex) {
+      // the block is pruned, only its base transaction is left
+      assert(blockIt->first < prunedBlockCount);
+      logger(Logging::DEBUGGING) << "transaction " << hash << " is in a pruned block, in getRawTransaction";
+      missedTransactions.push_back(hash);
     } else {
-      assert(blockIt->second.transactions.size() >= transactionIt->second.transactionIndex - 1);
       foundTransactions.emplace_back(blockIt->second.transactions[transactionIt->second.transactionIndex - 1]);
     }
   }
@@ -1574,13 +1893,29 @@ ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
     uint64_t amount, uint32_t blockIndex, Common::ArrayView<uint32_t> globalIndexes,
     std::function<ExtractOutputKeysResult(const CachedTransactionInfo& info, PackedOutIndex index,
                                           uint32_t globalIndex)> callback) const {
+  std::map<std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>, KeyOutputInfo> sortedResult;
+
   BlockchainReadBatch batch;
+  bool hasMisses = false;
   for (auto it = globalIndexes.begin(); it != globalIndexes.end(); ++it) {
-    batch.requestKeyOutputInfo(amount, *it);
+    const auto key = std::make_pair(amount, *it);
+
+    KeyOutputInfo info;
+    if (keyOutputCache.get(key, info)) {
+      sortedResult.emplace(key, info);
+    } else {
+      batch.requestKeyOutputInfo(amount, *it);
+      hasMisses = true;
+    }
+  }
+
+  if (hasMisses) {
+    for (const auto& kv: readDatabase(batch).getKeyOutputInfo()) {
+      keyOutputCache.insert(kv.first, kv.second);
+      sortedResult.emplace(kv);
+    }
   }
 
-  auto result = readDatabase(batch).getKeyOutputInfo();
-  std::map<std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>, KeyOutputInfo> sortedResult(result.begin(), result.end());
   for (const auto& kv: sortedResult) {
     ExtendedTransactionInfo tx;
     tx.unlockTime = kv.second.unlockTime;
@@ -1626,19 +1961,21 @@ std::vector<Crypto::Hash> DatabaseBlockchainCache::getBlockHashesByTimestamps(ui
     return blockHashes;
   }
 
+  const auto indexes = timestampIndex.getBlockIndexes(timestampBegin, timestampBegin + static_cast<uint64_t>(secondsCount) - 1);
+  if (indexes.empty()) {
+    return blockHashes;
+  }
+
   BlockchainReadBatch batch;
-  for (uint64_t timestamp = timestampBegin; timestamp < timestampBegin + static_cast<uint64_t>(secondsCount); ++timestamp) {
-    batch.requestBlockHashesByTimestamp(timestamp);
+  for (const auto index: indexes) {
+    batch.requestCachedBlock(index);
   }
 
   auto result = readDatabase(batch);
-  for (uint64_t timestamp = timestampBegin; timestamp < timestampBegin + static_cast<uint64_t>(secondsCount); ++timestamp) {
-    if (result.getBlockHashesByTimestamp().count(timestamp) == 0) {
-      continue;
-    }
 
-    const auto& hashes = result.getBlockHashesByTimestamp().at(timestamp);
-    blockHashes.insert(blockHashes.end(), hashes.begin(), hashes.end());
+  blockHashes.reserve(indexes.size());
+  for (const auto index: indexes) {
+    blockHashes.push_back(result.getCachedBlocks().at(index).blockHash);
   }
 
   return blockHashes;
@@ -1663,6 +2000,60 @@ std::vector<RawBlock> DatabaseBlockchainCache::getBlocksByHeight(
     return orderedBlocks;
 }
 
+std::vector<WalletTypes::WalletBlockInfo> DatabaseBlockchainCache::getWalletBlockInfos(
+    const uint64_t startHeight, const uint64_t endHeight) const
+{
+    auto walletBatch = BlockchainReadBatch().requestWalletBlockInfos(startHeight, endHeight);
+
+    auto walletBlockInfos = readDatabase(walletBatch).getWalletBlockInfos();
+
+    /* Blocks added before the wallet sync data was stored don't have it, so
+       build theirs from the raw block */
+    BlockchainReadBatch rawBatch;
+
+    bool missingBlocks = false;
+
+    for (uint64_t height = startHeight; height < endHeight; height++)
+    {
+        if (walletBlockInfos.find(static_cast<uint32_t>(height)) == walletBlockInfos.end())
+        {
+            rawBatch.requestRawBlock(static_cast<uint32_t>(height));
+            missingBlocks = true;
+        }
+    }
+
+    std::unordered_map<uint32_t, RawBlock> rawBlocks;
+
+    if (missingBlocks)
+    {
+        rawBlocks = readDatabase(rawBatch).getRawBlocks();
+    }
+
+    std::vector<WalletTypes::WalletBlockInfo> orderedBlocks;
+
+    /* Order, and convert from map, to vector. Stop at the first block we
+       don't have at all. */
+    for (uint64_t height = startHeight; height < endHeight; height++)
+    {
+        const auto index = static_cast<uint32_t>(height);
+
+        if (const auto it = walletBlockInfos.find(index); it != walletBlockInfos.end())
+        {
+            orderedBlocks.push_back(std::move(it->second));
+        }
+        else if (const auto raw = rawBlocks.find(index); raw != rawBlocks.end())
+        {
+            orderedBlocks.push_back(Utils::getWalletBlockInfo(height, raw->second));
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return orderedBlocks;
+}
+
 std::unordered_map<Crypto::Hash, std::vector<uint64_t>> DatabaseBlockchainCache::getGlobalIndexes(
     const std::vector<Crypto::Hash> transactionHashes) const
 {
@@ -1682,6 +2073,60 @@ std::unordered_map<Crypto::Hash, std::vector<uint64_t>> DatabaseBlockchainCache:
     return indexes;
 }
 
+std::unordered_map<Crypto::Hash, std::vector<uint64_t>> DatabaseBlockchainCache::getGlobalIndexesForRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const
+{
+    auto indexesBatch = BlockchainReadBatch().requestGlobalIndexesByBlocks(startHeight, endHeight);
+
+    const auto globalIndexesByBlocks = readDatabase(indexesBatch).getGlobalIndexesByBlocks();
+
+    std::unordered_map<Crypto::Hash, std::vector<uint64_t>> indexes;
+
+    /* Blocks added before the global indexes were stored per block don't
+       have them, so look up their transactions instead */
+    BlockchainReadBatch hashesBatch;
+
+    bool missingBlocks = false;
+
+    for (uint64_t height = startHeight; height < endHeight; height++)
+    {
+        const auto it = globalIndexesByBlocks.find(static_cast<uint32_t>(height));
+
+        if (it == globalIndexesByBlocks.end())
+        {
+            hashesBatch.requestTransactionHashesByBlock(static_cast<uint32_t>(height));
+            missingBlocks = true;
+            continue;
+        }
+
+        for (const auto &transaction : it->second)
+        {
+            indexes[transaction.transactionHash].assign(
+                transaction.globalIndexes.begin(), transaction.globalIndexes.end()
+            );
+        }
+    }
+
+    if (missingBlocks)
+    {
+        std::vector<Crypto::Hash> transactionHashes;
+
+        for (const auto &[blockIndex, hashes] : readDatabase(hashesBatch).getTransactionHashesByBlocks())
+        {
+            transactionHashes.insert(transactionHashes.end(), hashes.begin(), hashes.end());
+        }
+
+        if (!transactionHashes.empty())
+        {
+            const auto missingIndexes = getGlobalIndexes(transactionHashes);
+            indexes.insert(missingIndexes.begin(), missingIndexes.end());
+        }
+    }
+
+    return indexes;
+}
+
 DatabaseBlockchainCache::ExtendedPushedBlockInfo DatabaseBlockchainCache::getExtendedPushedBlockInfo(uint32_t blockIndex) const {
   assert(blockIndex <= getTopBlockIndex());
 
@@ -1760,10 +2205,12 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   auto baseTransaction = genesisBlock.getBlock().baseTransaction;
   auto cachedBaseTransaction = CachedTransaction{std::move(baseTransaction)};
 
-  pushTransaction(cachedBaseTransaction, 0, 0, batch);
+  auto baseTransactionGlobalIndexes = pushTransaction(cachedBaseTransaction, 0, 0, batch);
 
   batch.insertCachedBlock(blockInfo, 0, {cachedBaseTransaction.getTransactionHash()});
   batch.insertRawBlock(0, {toBinaryArray(genesisBlock.getBlock()), {}});
+  batch.insertWalletBlockInfo(0, Utils::getWalletBlockInfo(0, genesisBlock, cachedBaseTransaction, {}));
+  batch.insertGlobalIndexes(0, {baseTransactionGlobalIndexes});
   batch.insertClosestTimestampBlockIndex(roundToMidnight(genesisBlock.getBlock().timestamp), 0);
 
   auto res = database.write(batch);
@@ -1777,4 +2224,53 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   unitsCache.push_back(blockInfo);
 }
 
+uint64_t DatabaseBlockchainCache::getKeyOutputCacheHits() const {
+  return keyOutputCache.getHits();
+}
+
+uint64_t DatabaseBlockchainCache::getKeyOutputCacheMisses() const {
+  return keyOutputCache.getMisses();
+}
+
+uint32_t DatabaseBlockchainCache::pruneRawBlocks(uint32_t endIndex, uint32_t maxCount) {
+  endIndex = std::min({endIndex, getTopBlockIndex() + 1, prunedBlockCount + maxCount});
+
+  if (endIndex <= prunedBlockCount) {
+    return prunedBlockCount;
+  }
+
+  auto readBatch = BlockchainReadBatch().requestRawBlocks(prunedBlockCount, endIndex);
+  auto rawBlocks = readDatabase(readBatch).getRawBlocks();
+
+  BlockchainWriteBatch writeBatch;
+  for (const auto& [blockIndex, rawBlock] : rawBlocks) {
+    if (!rawBlock.transactions.empty()) {
+      writeBatch.insertRawBlock(blockIndex, {rawBlock.block, {}});
+    }
+  }
+
+  auto error = database.write(writeBatch);
+  if (error) {
+    logger(Logging::ERROR) << "Failed to write pruned blocks: " << error.message();
+    throw std::system_error(error);
+  }
+
+  // written after the blocks, if we're interrupted in between they're just pruned again
+  PrunedBlockCountWriteBatch countBatch(endIndex);
+  error = database.write(countBatch);
+  if (error) {
+    logger(Logging::ERROR) << "Failed to write pruned block count: " << error.message();
+    throw std::system_error(error);
+  }
+
+  logger(Logging::DEBUGGING) << "Pruned blocks " << prunedBlockCount << " to " << endIndex - 1;
+
+  prunedBlockCount = endIndex;
+  return prunedBlockCount;
+}
+
+uint32_t DatabaseBlockchainCache::getPrunedBlockCount() const {
+  return prunedBlockCount;
+}
+
 }
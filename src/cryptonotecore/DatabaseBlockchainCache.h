@@ -17,15 +17,19 @@
 
 #pragma once
 
+#include "Common/RollingMedian.h"
+#include "Common/ShardedLruCache.h"
 #include "Common/StringView.h"
 #include "Currency.h"
 #include "IBlockchainCache.h"
 #include "CryptoNoteCore/UpgradeManager.h"
 #include <IDataBase.h>
+#include <CryptoNoteCore/BlockTimestampIndex.h>
 #include <CryptoNoteCore/BlockchainReadBatch.h>
 #include <CryptoNoteCore/BlockchainWriteBatch.h>
 #include <CryptoNoteCore/DatabaseCacheData.h>
 #include <CryptoNoteCore/IBlockchainCacheFactory.h>
+#include <CryptoNoteCore/SpentKeyImageFilter.h>
 
 namespace CryptoNote {
 
@@ -46,7 +50,8 @@ public:
    * BlockchainCache objects as children are supported.
    */
   DatabaseBlockchainCache(const Currency& currency, IDataBase& dataBase,
-                          IBlockchainCacheFactory& blockchainCacheFactory, std::shared_ptr<Logging::ILogger> logger);
+                          IBlockchainCacheFactory& blockchainCacheFactory, std::shared_ptr<Logging::ILogger> logger,
+                          size_t keyOutputCacheSize = KEY_OUTPUT_CACHE_DEFAULT_SIZE);
 
   static bool checkDBSchemeVersion(IDataBase& dataBase, std::shared_ptr<Logging::ILogger> logger);
 
@@ -91,6 +96,7 @@ public:
 
   std::vector<uint64_t> getLastBlocksSizes(size_t count) const override;
   std::vector<uint64_t> getLastBlocksSizes(size_t count, uint32_t blockIndex, UseGenesis) const override;
+  uint64_t getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis) const override;
 
   std::vector<uint64_t> getLastCumulativeDifficulties(size_t count, uint32_t blockIndex, UseGenesis) const override;
   std::vector<uint64_t> getLastCumulativeDifficulties(size_t count) const override;
@@ -124,6 +130,10 @@ public:
   virtual std::unordered_map<Crypto::Hash, std::vector<uint64_t>> getGlobalIndexes(
     const std::vector<Crypto::Hash> transactionHashes) const override;
 
+  virtual std::unordered_map<Crypto::Hash, std::vector<uint64_t>> getGlobalIndexesForRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const override;
+
   virtual bool getTransactionGlobalIndexes(const Crypto::Hash& transactionHash,
                                            std::vector<uint32_t>& globalIndexes) const override;
   virtual size_t getTransactionCount() const override;
@@ -167,6 +177,16 @@ public:
     const uint64_t startHeight,
     const uint64_t endHeight) const override;
 
+  virtual std::vector<WalletTypes::WalletBlockInfo> getWalletBlockInfos(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const override;
+
+  virtual uint64_t getKeyOutputCacheHits() const override;
+  virtual uint64_t getKeyOutputCacheMisses() const override;
+
+  virtual uint32_t pruneRawBlocks(uint32_t endIndex, uint32_t maxCount) override;
+  virtual uint32_t getPrunedBlockCount() const override;
+
 private:
   const Currency& currency;
   IDataBase& database;
@@ -180,6 +200,17 @@ private:
   Logging::LoggerRef logger;
   std::deque<CachedBlockInfo> unitsCache;
   const size_t unitsCacheSize = 1000;
+  // sizes of the last rewardBlocksWindow blocks, filled on first use and after split
+  mutable Common::RollingMedian<uint64_t> blockSizesWindow;
+  mutable bool blockSizesWindowFilled = false;
+  // null until load(), every lookup goes to the database until then
+  std::unique_ptr<SpentKeyImageFilter> spentKeyImagesFilter;
+  // ring members of recently validated transactions, popular decoys are requested over and over
+  mutable Common::ShardedLruCache<std::pair<Amount, GlobalOutputIndex>, KeyOutputInfo> keyOutputCache;
+  // raw blocks below this index have had their transactions dropped
+  uint32_t prunedBlockCount = 0;
+  // timestamps of every block, read from the database on construction
+  BlockTimestampIndex timestampIndex;
 
   struct ExtendedPushedBlockInfo;
   ExtendedPushedBlockInfo getExtendedPushedBlockInfo(uint32_t blockIndex) const;
@@ -188,11 +219,17 @@ private:
   CachedBlockInfo getCachedBlockInfo(uint32_t index) const;
   BlockchainReadResult readDatabase(BlockchainReadBatch& batch) const;
 
+  void loadTimestampIndex();
+
   void addSpentKeyImage(const Crypto::KeyImage& keyImage, uint32_t blockIndex);
-  void pushTransaction(const CachedTransaction& cachedTransaction,
-                       uint32_t blockIndex,
-                       uint16_t transactionBlockIndex,
-                       BlockchainWriteBatch& batch);
+  void loadSpentKeyImagesFilter();
+  void buildSpentKeyImagesFilter(size_t capacity);
+  void saveSpentKeyImagesFilter();
+  void addSpentKeyImagesToFilter(SpentKeyImageFilter& filter, uint32_t startIndex) const;
+  TransactionGlobalIndexes pushTransaction(const CachedTransaction& cachedTransaction,
+                                           uint32_t blockIndex,
+                                           uint16_t transactionBlockIndex,
+                                           BlockchainWriteBatch& batch);
 
   uint32_t insertKeyOutputToGlobalIndex(uint64_t amount, PackedOutIndex output); //TODO not implemented. Should it be removed?
   uint32_t updateKeyOutputCount(Amount amount, int32_t diff) const;
@@ -19,6 +19,7 @@
 
 #include "IBlockchainCacheFactory.h"
 #include <Logging/LoggerMessage.h>
+#include <config/CryptoNoteConfig.h>
 
 namespace CryptoNote {
 
@@ -26,7 +27,8 @@ class IDataBase;
 
 class DatabaseBlockchainCacheFactory: public IBlockchainCacheFactory {
 public:
-  explicit DatabaseBlockchainCacheFactory(IDataBase& database, std::shared_ptr<Logging::ILogger> logger);
+  explicit DatabaseBlockchainCacheFactory(IDataBase& database, std::shared_ptr<Logging::ILogger> logger,
+                                          size_t keyOutputCacheSize = KEY_OUTPUT_CACHE_DEFAULT_SIZE);
   virtual ~DatabaseBlockchainCacheFactory();
 
   virtual std::unique_ptr<IBlockchainCache> createRootBlockchainCache(const Currency& currency) override;
@@ -35,6 +37,7 @@ public:
 private:
   IDataBase& database;
   std::shared_ptr<Logging::ILogger> logger;
+  size_t keyOutputCacheSize;
 };
 
 } //namespace CryptoNote
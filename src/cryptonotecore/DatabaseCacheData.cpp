@@ -34,4 +34,9 @@ void KeyOutputInfo::serialize(ISerializer& s) {
   s(outputIndex, "output_index");
 }
 
+void TransactionGlobalIndexes::serialize(ISerializer& s) {
+  s(transactionHash, "transaction_hash");
+  s(globalIndexes, "global_indexes");
+}
+
 }
@@ -31,6 +31,14 @@ struct KeyOutputInfo {
   void serialize(CryptoNote::ISerializer& s);
 };
 
+// global key output indexes of one of a block's transactions
+struct TransactionGlobalIndexes {
+  Crypto::Hash transactionHash;
+  std::vector<IBlockchainCache::GlobalOutputIndex> globalIndexes;
+
+  void serialize(CryptoNote::ISerializer& s);
+};
+
 // inherit here to avoid breaking IBlockchainCache interface
 struct ExtendedTransactionInfo : CachedTransactionInfo {
   //CachedTransactionInfo tx;
@@ -0,0 +1,247 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "GroupCommitDataBase.h"
+
+#include <cassert>
+
+using namespace Logging;
+
+namespace CryptoNote {
+
+namespace {
+
+/* The overlay, as a batch for the database behind it */
+class OverlayWriteBatch : public IWriteBatch {
+public:
+  OverlayWriteBatch(const std::unordered_map<std::string, boost::optional<std::string>>& overlay) {
+    for (const auto& [key, value] : overlay) {
+      if (value) {
+        rawDataToInsert.emplace_back(key, *value);
+      } else {
+        rawKeysToRemove.push_back(key);
+      }
+    }
+  }
+
+  virtual std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override {
+    return std::move(rawDataToInsert);
+  }
+
+  virtual std::vector<std::string> extractRawKeysToRemove() override {
+    return std::move(rawKeysToRemove);
+  }
+
+private:
+  std::vector<std::pair<std::string, std::string>> rawDataToInsert;
+  std::vector<std::string> rawKeysToRemove;
+};
+
+/* The keys of a read batch which aren't in the overlay */
+class MissingKeysReadBatch : public IReadBatch {
+public:
+  MissingKeysReadBatch(std::vector<std::string>&& keys) : keys(std::move(keys)) {
+  }
+
+  virtual std::vector<std::string> getRawKeys() const override {
+    return keys;
+  }
+
+  virtual void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override {
+    this->values = values;
+    this->resultStates = resultStates;
+  }
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  std::vector<bool> resultStates;
+};
+
+}
+
+GroupCommitDataBase::GroupCommitDataBase(IDataBase& database, std::shared_ptr<Logging::ILogger> logger, size_t maxBatches,
+                                         size_t maxSize, std::chrono::milliseconds maxAge) :
+  database(database),
+  logger(logger, "GroupCommitDataBase"),
+  maxBatches(maxBatches),
+  maxSize(maxSize),
+  maxAge(maxAge),
+  pendingBatches(0),
+  pendingSize(0) {
+}
+
+GroupCommitDataBase::~GroupCommitDataBase() {
+  auto error = flush();
+  if (error) {
+    logger(ERROR) << "Failed to commit pending writes on shutdown: " << error.message();
+  }
+}
+
+std::error_code GroupCommitDataBase::write(IWriteBatch& batch) {
+  std::scoped_lock lock(mutex);
+
+  const size_t previousSize = pendingSize;
+  const auto previousOldestWrite = oldestPendingWrite;
+
+  if (pendingBatches == 0) {
+    oldestPendingWrite = std::chrono::steady_clock::now();
+  }
+
+  /* The overlay entries this batch replaces, so it can be taken back out if
+     committing it fails. An empty entry is a key which wasn't in the overlay. */
+  std::unordered_map<std::string, boost::optional<boost::optional<std::string>>> replaced;
+
+  const auto apply = [this, &replaced](std::string&& key, boost::optional<std::string>&& value) {
+    auto [it, inserted] = overlay.try_emplace(key);
+
+    if (inserted) {
+      pendingSize += key.size();
+      replaced.try_emplace(std::move(key));
+    } else {
+      if (it->second) {
+        pendingSize -= it->second->size();
+      }
+
+      replaced.try_emplace(std::move(key), std::move(it->second));
+    }
+
+    if (value) {
+      pendingSize += value->size();
+    }
+
+    it->second = std::move(value);
+  };
+
+  /* Applied in the same order the database applies a batch, so a key both
+     inserted and removed in one batch ends up removed */
+  for (auto& [key, value] : batch.extractRawDataToInsert()) {
+    apply(std::move(key), std::move(value));
+  }
+
+  for (auto& key : batch.extractRawKeysToRemove()) {
+    apply(std::move(key), boost::none);
+  }
+
+  ++pendingBatches;
+
+  if (pendingBatches >= maxBatches || pendingSize >= maxSize
+      || std::chrono::steady_clock::now() - oldestPendingWrite >= maxAge) {
+    auto error = flushLocked();
+
+    /* Failed just like a write straight to the database would, so this
+       batch is dropped. The earlier ones stay pending, to be committed
+       with the next write. */
+    if (error) {
+      for (auto& [key, entry] : replaced) {
+        if (entry) {
+          overlay[key] = std::move(*entry);
+        } else {
+          overlay.erase(key);
+        }
+      }
+
+      --pendingBatches;
+      pendingSize = previousSize;
+      oldestPendingWrite = previousOldestWrite;
+    }
+
+    return error;
+  }
+
+  return std::error_code();
+}
+
+std::error_code GroupCommitDataBase::read(IReadBatch& batch) {
+  std::vector<std::string> keys = batch.getRawKeys();
+  std::vector<std::string> values(keys.size());
+  std::vector<bool> resultStates(keys.size(), false);
+
+  /* Indexes of the keys not in the overlay */
+  std::vector<size_t> missing;
+  std::vector<std::string> missingKeys;
+
+  {
+    std::scoped_lock lock(mutex);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+      auto it = overlay.find(keys[i]);
+
+      if (it == overlay.end()) {
+        missing.push_back(i);
+        missingKeys.push_back(keys[i]);
+      } else if (it->second) {
+        values[i] = *it->second;
+        resultStates[i] = true;
+      }
+    }
+  }
+
+  if (!missingKeys.empty()) {
+    MissingKeysReadBatch missingBatch(std::move(missingKeys));
+
+    auto error = database.read(missingBatch);
+    if (error) {
+      return error;
+    }
+
+    assert(missingBatch.values.size() == missing.size());
+
+    for (size_t i = 0; i < missing.size(); ++i) {
+      values[missing[i]] = std::move(missingBatch.values[i]);
+      resultStates[missing[i]] = missingBatch.resultStates[i];
+    }
+  }
+
+  batch.submitRawResult(values, resultStates);
+  return std::error_code();
+}
+
+std::error_code GroupCommitDataBase::flush() {
+  std::scoped_lock lock(mutex);
+
+  return flushLocked();
+}
+
+std::error_code GroupCommitDataBase::createCheckpoint(const std::string& directory) {
+  /* Held until the checkpoint is taken, so it has every write made so far */
+  std::scoped_lock lock(mutex);
+
+  auto error = flushLocked();
+  if (error) {
+    return error;
+  }
+
+  return database.createCheckpoint(directory);
+}
+
+DataBaseStatistics GroupCommitDataBase::getStatistics() const {
+  /* Writes still in the overlay aren't counted until they're committed */
+  return database.getStatistics();
+}
+
+std::error_code GroupCommitDataBase::flushLocked() {
+  if (overlay.empty()) {
+    return std::error_code();
+  }
+
+  logger(DEBUGGING) << "Committing " << pendingBatches << " writes, " << overlay.size() << " keys";
+
+  /* The overlay is only dropped once the database has the writes, reads
+     would otherwise miss them */
+  OverlayWriteBatch batch(overlay);
+
+  auto error = database.write(batch);
+  if (error) {
+    logger(ERROR) << "Failed to commit " << pendingBatches << " writes: " << error.message();
+    return error;
+  }
+
+  overlay.clear();
+  pendingBatches = 0;
+  pendingSize = 0;
+
+  return std::error_code();
+}
+
+}
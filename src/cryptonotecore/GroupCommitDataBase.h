@@ -0,0 +1,66 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "IDataBase.h"
+
+#include <Logging/LoggerRef.h>
+
+namespace CryptoNote {
+
+/* Sits in front of another database, and merges the write batches of
+   several consecutive blocks into a single write, which cuts the write
+   amplification of syncing a lot of blocks. Writes not yet committed are
+   kept in an overlay, which reads check first, so they are seen as soon as
+   they are written.
+
+   The overlay is committed once it holds maxBatches writes, maxSize bytes,
+   or its oldest write is maxAge old, and whenever flush() is called. If the
+   daemon dies with writes uncommitted, the database is just behind the main
+   chain storage, and the missing blocks are imported from it on startup. */
+class GroupCommitDataBase : public IDataBase {
+public:
+  GroupCommitDataBase(IDataBase& database, std::shared_ptr<Logging::ILogger> logger, size_t maxBatches, size_t maxSize,
+                      std::chrono::milliseconds maxAge);
+  virtual ~GroupCommitDataBase();
+
+  GroupCommitDataBase(const GroupCommitDataBase&) = delete;
+  GroupCommitDataBase& operator=(const GroupCommitDataBase&) = delete;
+
+  virtual std::error_code write(IWriteBatch& batch) override;
+  virtual std::error_code read(IReadBatch& batch) override;
+
+  virtual std::error_code flush() override;
+  virtual std::error_code createCheckpoint(const std::string& directory) override;
+  virtual DataBaseStatistics getStatistics() const override;
+
+private:
+  std::error_code flushLocked();
+
+  IDataBase& database;
+  Logging::LoggerRef logger;
+
+  const size_t maxBatches;
+  const size_t maxSize;
+  const std::chrono::milliseconds maxAge;
+
+  std::mutex mutex;
+
+  /* Keys written since the last commit. An empty value is a removed key. */
+  std::unordered_map<std::string, boost::optional<std::string>> overlay;
+
+  size_t pendingBatches;
+  size_t pendingSize;
+  std::chrono::steady_clock::time_point oldestPendingWrite;
+};
+
+}
@@ -28,6 +28,8 @@
 #include "CryptoNoteCore/TransactionValidatiorState.h"
 #include "Common/ArrayView.h"
 
+#include <WalletTypes.h>
+
 namespace CryptoNote {
 
 class ISerializer;
@@ -124,6 +126,7 @@ public:
 
   virtual std::vector<uint64_t> getLastBlocksSizes(size_t count) const = 0;
   virtual std::vector<uint64_t> getLastBlocksSizes(size_t count, uint32_t blockIndex, UseGenesis) const = 0;
+  virtual uint64_t getLastBlocksSizesMedian(size_t count, uint32_t blockIndex, UseGenesis) const = 0;
 
   virtual std::vector<uint64_t> getLastCumulativeDifficulties(size_t count, uint32_t blockIndex, UseGenesis) const = 0;
   virtual std::vector<uint64_t> getLastCumulativeDifficulties(size_t count) const = 0;
@@ -165,6 +168,11 @@ public:
   virtual std::unordered_map<Crypto::Hash, std::vector<uint64_t>> getGlobalIndexes( 
     const std::vector<Crypto::Hash> transactionHashes) const = 0;
 
+  /* The global indexes of every transaction in the blocks [startHeight, endHeight) */
+  virtual std::unordered_map<Crypto::Hash, std::vector<uint64_t>> getGlobalIndexesForRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const = 0;
+
   virtual size_t getTransactionCount() const = 0;
 
   virtual uint32_t getBlockIndexContainingTx(const Crypto::Hash& transactionHash) const = 0;
@@ -187,6 +195,22 @@ public:
   virtual std::vector<RawBlock> getBlocksByHeight(
     const uint64_t startHeight,
     uint64_t endHeight) const = 0;
+
+  /* The wallet sync data of the blocks [startHeight, endHeight) */
+  virtual std::vector<WalletTypes::WalletBlockInfo> getWalletBlockInfos(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const = 0;
+
+  virtual uint64_t getKeyOutputCacheHits() const = 0;
+  virtual uint64_t getKeyOutputCacheMisses() const = 0;
+
+  /* Drops the transactions of the raw blocks below endIndex, at most
+     maxCount blocks at a time, returning the new pruned block count */
+  virtual uint32_t pruneRawBlocks(uint32_t endIndex, uint32_t maxCount) = 0;
+
+  /* Blocks below this index are only their headers, their transactions
+     have been dropped */
+  virtual uint32_t getPrunedBlockCount() const = 0;
 };
 
 }
@@ -36,6 +36,8 @@ public:
 
   virtual uint32_t getTopBlockIndex() const = 0;
   virtual Crypto::Hash getTopBlockHash() const = 0;
+  /* Blocks below this height are kept without their transactions */
+  virtual uint32_t getPrunedHeight() const = 0;
   virtual Crypto::Hash getBlockHashByIndex(uint32_t blockIndex) const = 0;
   virtual uint64_t getBlockTimestampByIndex(uint32_t blockIndex) const = 0;
 
@@ -48,6 +50,8 @@ public:
                                                              size_t maxCount, uint32_t& totalBlockCount,
                                                              uint32_t& startBlockIndex) const = 0;
 
+  /* Pruned blocks aren't returned, so a range starting below getPrunedHeight()
+     gives fewer than count blocks, those from the pruned height on */
   virtual std::vector<RawBlock> getBlocks(uint32_t startIndex, uint32_t count) const = 0;
   virtual void getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<RawBlock>& blocks,
                          std::vector<Crypto::Hash>& missedHashes) const = 0;
@@ -92,6 +96,12 @@ public:
 
   virtual std::error_code submitBlock(BinaryArray&& rawBlockTemplate) = 0;
 
+  /* Calculate the proof of work hashes of a batch of blocks in parallel,
+     ahead of them being passed to addBlock. Only blocks which connect to
+     a known block, directly or through the batch, are hashed, up to
+     VALIDATION_PRECALCULATE_MAX_BLOCKS of them */
+  virtual void precalculateBlockLongHashes(const std::vector<CachedBlock>& cachedBlocks) = 0;
+
   virtual bool getTransactionGlobalIndexes(const Crypto::Hash& transactionHash,
                                            std::vector<uint32_t>& globalIndexes) const = 0;
   virtual bool getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_t>& globalIndexes,
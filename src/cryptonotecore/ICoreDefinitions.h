@@ -22,6 +22,8 @@
 #include <CryptoTypes.h>
 #include <WalletTypes.h>
 
+#include "WalletTypesSerialization.h"
+
 namespace CryptoNote {
 
 struct BlockFullInfo : public RawBlock {
@@ -43,9 +45,4 @@ void serialize(BlockFullInfo&, ISerializer&);
 void serialize(TransactionPrefixInfo&, ISerializer&);
 void serialize(BlockShortInfo&, ISerializer&);
 
-void serialize(WalletTypes::WalletBlockInfo &walletBlockInfo, ISerializer &s);
-void serialize(WalletTypes::RawTransaction &rawTransaction, ISerializer &s);
-void serialize(WalletTypes::RawCoinbaseTransaction &rawCoinbaseTransaction, ISerializer &s);
-void serialize(WalletTypes::KeyOutput &keyOutput, ISerializer &s);
-
 }
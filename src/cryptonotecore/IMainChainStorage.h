@@ -19,6 +19,8 @@
 
 #include <CryptoNote.h>
 
+#include <vector>
+
 namespace CryptoNote {
 
 class IMainChainStorage {
@@ -30,9 +32,44 @@ public:
   virtual void rewindTo(uint32_t index) const = 0;
 
   virtual RawBlock getBlockByIndex(uint32_t index) const = 0;
+
+  /* Blocks [startIndex, endIndex). Storages which can read a range in one go
+     override this. */
+  virtual std::vector<RawBlock> getBlocksByIndexRange(uint32_t startIndex, uint32_t endIndex) const {
+    std::vector<RawBlock> rawBlocks;
+
+    for (uint32_t index = startIndex; index < endIndex; ++index) {
+      rawBlocks.push_back(getBlockByIndex(index));
+    }
+
+    return rawBlocks;
+  }
   virtual uint32_t getBlockCount() const = 0;
 
   virtual void clear() = 0;
+
+  /* Writes any pushed blocks the storage is holding back to write together.
+     Called regularly by the core, so they aren't held back for long when
+     few blocks are being pushed. */
+  virtual void commit() { }
+
+  /* Rewrites any blocks stored in an older format in the current one,
+     returning how many were rewritten. Storages with a single format have
+     nothing to do. */
+  virtual uint32_t migrateRawBlocks() { return 0; }
+
+  /* Whether pruneBlocks() is supported, storages which can't rewrite a block
+     in place keep every block whole */
+  virtual bool canPruneBlocks() const = 0;
+
+  /* Drops the transactions of blocks [startIndex, endIndex), keeping the
+     blocks themselves, so their hashes and headers are still there. Throws
+     if canPruneBlocks() is false. */
+  virtual void pruneBlocks(uint32_t startIndex, uint32_t endIndex) = 0;
+
+  /* Blocks below this index have had their transactions dropped by
+     pruneBlocks(), so they can't be imported into a fresh DB */
+  virtual uint32_t getPrunedHeight() const { return 0; }
 };
 
 }
@@ -66,6 +66,14 @@ void MainChainStorage::clear() {
   storage.clear();
 }
 
+bool MainChainStorage::canPruneBlocks() const {
+  return false;
+}
+
+void MainChainStorage::pruneBlocks(uint32_t, uint32_t) {
+  throw std::runtime_error("The default main chain storage can't be pruned");
+}
+
 std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string& dataDir, const Currency& currency) {
   boost::filesystem::path blocksFilename = boost::filesystem::path(dataDir) / currency.blocksFileName();
   boost::filesystem::path indexesFilename = boost::filesystem::path(dataDir) / currency.blockIndexesFileName();
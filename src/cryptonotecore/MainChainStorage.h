@@ -37,6 +37,9 @@ public:
 
   virtual void clear() override;
 
+  virtual bool canPruneBlocks() const override;
+  virtual void pruneBlocks(uint32_t, uint32_t) override;
+
 private:
   mutable SwappedVector<RawBlock> storage;
 };
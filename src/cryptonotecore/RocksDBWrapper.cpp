@@ -17,10 +17,16 @@
 
 #include "RocksDBWrapper.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "rocksdb/cache.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/slice_transform.h"
 #include "rocksdb/table.h"
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/backupable_db.h"
+#include "rocksdb/utilities/checkpoint.h"
 
 #include "DataBaseErrors.h"
 
@@ -30,9 +36,13 @@ using namespace Logging;
 namespace {
   const std::string DB_NAME = "DB";
   const std::string TESTNET_DB_NAME = "testnet_DB";
+
+  /* Keys moved per write while moving an old single family DB into families */
+  const size_t MIGRATION_BATCH_SIZE = 10000;
 }
 
-RocksDBWrapper::RocksDBWrapper(std::shared_ptr<Logging::ILogger> logger) : logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED){
+RocksDBWrapper::RocksDBWrapper(std::shared_ptr<Logging::ILogger> logger) : logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED),
+  statistics(rocksdb::CreateDBStatistics()), readBatches(0), writeBatches(0) {
 
 }
 
@@ -52,13 +62,16 @@ void RocksDBWrapper::init(const DataBaseConfig& config) {
   rocksdb::DB* dbPtr;
 
   rocksdb::Options dbOptions = getDBOptions(config);
-  rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+  std::vector<rocksdb::ColumnFamilyDescriptor> descriptors = getColumnFamilyDescriptors(config, dbOptions);
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+
+  rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &handles, &dbPtr);
   if (status.ok()) {
     logger(INFO) << "DB opened in " << dataDir;
   } else if (!status.ok() && status.IsInvalidArgument()) {
     logger(INFO) << "DB not found in " << dataDir << ". Creating new DB...";
     dbOptions.create_if_missing = true;
-    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &handles, &dbPtr);
     if (!status.ok()) {
       logger(ERROR) << "DB Error. DB can't be created in " << dataDir << ". Error: " << status.ToString();
       throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
@@ -72,6 +85,22 @@ void RocksDBWrapper::init(const DataBaseConfig& config) {
   }
 
   db.reset(dbPtr);
+  columnFamilies = handles;
+
+  /* Keys without a family of their own, such as the DB scheme version, stay
+     in the default family, which is always first */
+  columnFamiliesByPrefix.fill(columnFamilies[0]);
+
+  for (size_t i = 0; i < descriptors.size(); ++i) {
+    for (const auto& family : config.getColumnFamilies()) {
+      if (family.name == descriptors[i].name) {
+        columnFamiliesByPrefix[static_cast<unsigned char>(family.keyPrefix[0])] = columnFamilies[i];
+      }
+    }
+  }
+
+  moveKeysFromDefaultColumnFamily();
+
   state.store(INITIALIZED);
 }
 
@@ -81,8 +110,16 @@ void RocksDBWrapper::shutdown() {
   }
 
   logger(INFO) << "Closing DB.";
-  db->Flush(rocksdb::FlushOptions());
+  for (auto* family : columnFamilies) {
+    db->Flush(rocksdb::FlushOptions(), family);
+  }
   db->SyncWAL();
+
+  for (auto* family : columnFamilies) {
+    db->DestroyColumnFamilyHandle(family);
+  }
+  columnFamilies.clear();
+
   db.reset();
   state.store(NOT_INITIALIZED);
 }
@@ -122,14 +159,22 @@ std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
   rocksdb::WriteBatch rocksdbBatch;
   std::vector<std::pair<std::string, std::string>> rawData(batch.extractRawDataToInsert());
   for (const std::pair<std::string, std::string>& kvPair : rawData) {
-    rocksdbBatch.Put(rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
+    rocksdbBatch.Put(getColumnFamily(kvPair.first), rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
+
+    auto& counters = getKeyCounters(kvPair.first);
+    counters.keysWritten.fetch_add(1, std::memory_order_relaxed);
+    counters.bytesWritten.fetch_add(kvPair.first.size() + kvPair.second.size(), std::memory_order_relaxed);
   }
 
   std::vector<std::string> rawKeys(batch.extractRawKeysToRemove());
   for (const std::string& key : rawKeys) {
-    rocksdbBatch.Delete(rocksdb::Slice(key));
+    rocksdbBatch.Delete(getColumnFamily(key), rocksdb::Slice(key));
+
+    getKeyCounters(key).keysRemoved.fetch_add(1, std::memory_order_relaxed);
   }
 
+  writeBatches.fetch_add(1, std::memory_order_relaxed);
+
   rocksdb::Status status = db->Write(writeOptions, &rocksdbBatch);
 
   if (!status.ok()) {
@@ -149,33 +194,154 @@ std::error_code RocksDBWrapper::read(IReadBatch& batch) {
 
   std::vector<std::string> rawKeys(batch.getRawKeys());
   std::vector<rocksdb::Slice> keySlices;
+  std::vector<rocksdb::ColumnFamilyHandle*> keyFamilies;
   keySlices.reserve(rawKeys.size());
+  keyFamilies.reserve(rawKeys.size());
   for (const std::string& key : rawKeys) {
     keySlices.emplace_back(rocksdb::Slice(key));
+    keyFamilies.push_back(getColumnFamily(key));
   }
 
   std::vector<std::string> values;
   values.reserve(rawKeys.size());
-  std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keySlices, &values);
+  std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keyFamilies, keySlices, &values);
+
+  readBatches.fetch_add(1, std::memory_order_relaxed);
 
   std::error_code error;
   std::vector<bool> resultStates;
-  for (const rocksdb::Status& status : statuses) {
+  for (size_t i = 0; i < statuses.size(); ++i) {
+    const rocksdb::Status& status = statuses[i];
     if (!status.ok() && !status.IsNotFound()) {
       return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
     }
     resultStates.push_back(status.ok());
+
+    auto& counters = getKeyCounters(rawKeys[i]);
+    counters.keysRead.fetch_add(1, std::memory_order_relaxed);
+    if (status.ok()) {
+      counters.keysFound.fetch_add(1, std::memory_order_relaxed);
+      counters.bytesRead.fetch_add(values[i].size(), std::memory_order_relaxed);
+    }
   }
 
   batch.submitRawResult(values, resultStates);
   return std::error_code();
 }
 
+std::error_code RocksDBWrapper::createCheckpoint(const std::string& directory) {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
+  }
+
+  rocksdb::Checkpoint* checkpointPtr;
+
+  rocksdb::Status status = rocksdb::Checkpoint::Create(db.get(), &checkpointPtr);
+
+  if (!status.ok()) {
+    logger(ERROR) << "Can't create DB checkpoint. Error: " << status.ToString();
+    return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
+  }
+
+  std::unique_ptr<rocksdb::Checkpoint> checkpoint(checkpointPtr);
+
+  /* The memtables of every family are flushed first, so the checkpoint is
+     just hard links to the table files, rather than copies of the WAL */
+  status = checkpoint->CreateCheckpoint(directory);
+
+  if (!status.ok()) {
+    logger(ERROR) << "Can't create DB checkpoint in " << directory << ". Error: " << status.ToString();
+    return make_error_code(CryptoNote::error::DataBaseErrorCodes::IO_ERROR);
+  }
+
+  logger(INFO) << "DB checkpoint created in " << directory;
+  return std::error_code();
+}
+
+DataBaseStatistics RocksDBWrapper::getStatistics() const {
+  DataBaseStatistics result;
+
+  result.readBatches = readBatches.load(std::memory_order_relaxed);
+  result.writeBatches = writeBatches.load(std::memory_order_relaxed);
+
+  result.blockCacheHits = statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT);
+  result.blockCacheMisses = statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS);
+  result.stallMicros = statistics->getTickerCount(rocksdb::STALL_MICROS);
+  result.compactionBytesRead = statistics->getTickerCount(rocksdb::COMPACT_READ_BYTES);
+  result.compactionBytesWritten = statistics->getTickerCount(rocksdb::COMPACT_WRITE_BYTES);
+
+  const auto getLatency = [this](uint32_t histogram) {
+    rocksdb::HistogramData data;
+    statistics->histogramData(histogram, &data);
+
+    DataBaseLatency latency;
+    latency.count = data.count;
+    latency.median = data.median;
+    latency.percentile95 = data.percentile95;
+    latency.percentile99 = data.percentile99;
+    latency.max = data.max;
+    return latency;
+  };
+
+  result.readLatency = getLatency(rocksdb::DB_MULTIGET);
+  result.writeLatency = getLatency(rocksdb::DB_WRITE);
+
+  if (state.load() != INITIALIZED) {
+    return result;
+  }
+
+  uint64_t value;
+  if (db->GetIntProperty(rocksdb::DB::Properties::kIsWriteStopped, &value)) {
+    result.writesStopped = value != 0;
+  }
+
+  if (db->GetIntProperty(rocksdb::DB::Properties::kNumRunningCompactions, &value)) {
+    result.runningCompactions = value;
+  }
+
+  for (auto* family : columnFamilies) {
+    DataBaseFamilyStatistics familyResult;
+    familyResult.name = family->GetName();
+
+    for (size_t prefix = 0; prefix < keyCounters.size(); ++prefix) {
+      if (columnFamiliesByPrefix[prefix] != family) {
+        continue;
+      }
+
+      const auto& counters = keyCounters[prefix];
+      familyResult.keysRead += counters.keysRead.load(std::memory_order_relaxed);
+      familyResult.keysFound += counters.keysFound.load(std::memory_order_relaxed);
+      familyResult.bytesRead += counters.bytesRead.load(std::memory_order_relaxed);
+      familyResult.keysWritten += counters.keysWritten.load(std::memory_order_relaxed);
+      familyResult.keysRemoved += counters.keysRemoved.load(std::memory_order_relaxed);
+      familyResult.bytesWritten += counters.bytesWritten.load(std::memory_order_relaxed);
+    }
+
+    db->GetIntProperty(family, rocksdb::DB::Properties::kCurSizeAllMemTables, &familyResult.memtableBytes);
+    db->GetIntProperty(family, rocksdb::DB::Properties::kTotalSstFilesSize, &familyResult.tableBytes);
+    db->GetIntProperty(family, rocksdb::DB::Properties::kEstimateNumKeys, &familyResult.estimatedKeys);
+    db->GetIntProperty(family, rocksdb::DB::Properties::kBlockCacheUsage, &familyResult.blockCacheBytes);
+
+    std::string level0Files;
+    if (db->GetProperty(family, rocksdb::DB::Properties::kNumFilesAtLevelPrefix + "0", &level0Files)) {
+      familyResult.level0Files = std::strtoull(level0Files.c_str(), nullptr, 10);
+    }
+
+    result.families.push_back(std::move(familyResult));
+  }
+
+  return result;
+}
+
 rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig& config) {
   rocksdb::DBOptions dbOptions;
   dbOptions.IncreaseParallelism(config.getBackgroundThreadsCount());
   dbOptions.info_log_level = rocksdb::InfoLogLevel::WARN_LEVEL;
   dbOptions.max_open_files = config.getMaxOpenFiles();
+  dbOptions.create_missing_column_families = true;
+  dbOptions.statistics = statistics;
+  // every family gets write_buffer_size, cap the memtables of them all together
+  dbOptions.db_write_buffer_size = static_cast<size_t>(config.getWriteBufferSize()) * 2;
   
   rocksdb::ColumnFamilyOptions fOptions;
   fOptions.write_buffer_size = static_cast<size_t>(config.getWriteBufferSize());
@@ -211,14 +377,155 @@ rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig& config) {
   // bottom most use lz4hc
   fOptions.bottommost_compression = config.getCompressionEnabled() ? rocksdb::kLZ4HCCompression : rocksdb::kNoCompression;
 
+  uint64_t reservedCacheShare = 0;
+  for (const auto& family : config.getColumnFamilies()) {
+    reservedCacheShare += family.readCacheShare;
+  }
+
+  // the default family, and every family without a share of its own, split
+  // what's left of the read cache, so all the caches add up to its size
+  const uint64_t sharedCacheShare = reservedCacheShare < 100 ? 100 - reservedCacheShare : 0;
+  sharedBlockCache = rocksdb::NewLRUCache(std::max<uint64_t>(config.getReadCacheSize() * sharedCacheShare / 100, 1024 * 1024));
+
   rocksdb::BlockBasedTableOptions tableOptions;
-  tableOptions.block_cache = rocksdb::NewLRUCache(config.getReadCacheSize());
+  tableOptions.block_cache = sharedBlockCache;
   std::shared_ptr<rocksdb::TableFactory> tfp(NewBlockBasedTableFactory(tableOptions));
   fOptions.table_factory = tfp;
 
   return rocksdb::Options(dbOptions, fOptions);
 }
 
+std::vector<rocksdb::ColumnFamilyDescriptor> RocksDBWrapper::getColumnFamilyDescriptors(const DataBaseConfig& config,
+                                                                                       const rocksdb::Options& dbOptions) {
+  const uint64_t readCacheSize = config.getReadCacheSize();
+
+  const auto compressionLevel = config.getCompressionEnabled() ? rocksdb::kLZ4Compression : rocksdb::kNoCompression;
+
+  std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+  descriptors.emplace_back(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions(dbOptions));
+
+  for (const auto& family : config.getColumnFamilies()) {
+    rocksdb::ColumnFamilyOptions fOptions(dbOptions);
+
+    for (int i = 0; i < fOptions.num_levels; ++i) {
+      // don't compress l0 & l1
+      fOptions.compression_per_level[i] = (i < 2 || !family.compressionEnabled ? rocksdb::kNoCompression : compressionLevel);
+    }
+
+    if (!family.compressionEnabled) {
+      fOptions.bottommost_compression = rocksdb::kNoCompression;
+    }
+
+    if (family.prefixLength != 0) {
+      fOptions.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(family.prefixLength));
+    }
+
+    rocksdb::BlockBasedTableOptions tableOptions;
+    tableOptions.block_size = static_cast<size_t>(family.blockSize);
+    tableOptions.block_cache = family.readCacheShare != 0
+      ? rocksdb::NewLRUCache(readCacheSize * family.readCacheShare / 100)
+      : sharedBlockCache;
+
+    if (family.bloomFilterBitsPerKey != 0) {
+      tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(family.bloomFilterBitsPerKey, false));
+    }
+
+    fOptions.table_factory.reset(rocksdb::NewBlockBasedTableFactory(tableOptions));
+
+    descriptors.emplace_back(family.name, fOptions);
+  }
+
+  /* Families we don't know about (created by a newer version) must still be
+     opened, rocksdb refuses to open the DB otherwise */
+  std::vector<std::string> existingFamilies;
+  if (rocksdb::DB::ListColumnFamilies(dbOptions, getDataDir(config), &existingFamilies).ok()) {
+    for (const auto& name : existingFamilies) {
+      auto it = std::find_if(descriptors.begin(), descriptors.end(), [&name](const auto& descriptor) {
+        return descriptor.name == name;
+      });
+
+      if (it == descriptors.end()) {
+        descriptors.emplace_back(name, rocksdb::ColumnFamilyOptions(dbOptions));
+      }
+    }
+  }
+
+  return descriptors;
+}
+
+rocksdb::ColumnFamilyHandle* RocksDBWrapper::getColumnFamily(const std::string& key) const {
+  return key.empty() ? columnFamilies[0] : columnFamiliesByPrefix[static_cast<unsigned char>(key[0])];
+}
+
+RocksDBWrapper::KeyCounters& RocksDBWrapper::getKeyCounters(const std::string& key) {
+  return keyCounters[key.empty() ? 0 : static_cast<unsigned char>(key[0])];
+}
+
+/* DBs from before the data was split into column families have every key in
+   the default family. Move them to their own family, a batch at a time. */
+void RocksDBWrapper::moveKeysFromDefaultColumnFamily() {
+  std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(rocksdb::ReadOptions(), columnFamilies[0]));
+
+  rocksdb::WriteBatch batch;
+  size_t batchCount = 0;
+  uint64_t movedCount = 0;
+
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    const std::string key = it->key().ToString();
+    auto* family = getColumnFamily(key);
+
+    if (family == columnFamilies[0]) {
+      continue;
+    }
+
+    if (movedCount == 0) {
+      logger(INFO) << "Moving DB to column families, this may take a while...";
+    }
+
+    batch.Put(family, it->key(), it->value());
+    batch.Delete(columnFamilies[0], it->key());
+
+    ++movedCount;
+
+    if (++batchCount == MIGRATION_BATCH_SIZE) {
+      rocksdb::Status status = db->Write(rocksdb::WriteOptions(), &batch);
+      if (!status.ok()) {
+        logger(ERROR) << "DB Error. Can't move keys to column families. Error: " << status.ToString();
+        throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+      }
+
+      batch.Clear();
+      batchCount = 0;
+
+      if (movedCount % (MIGRATION_BATCH_SIZE * 100) == 0) {
+        logger(INFO) << "Moved " << movedCount << " keys";
+      }
+    }
+  }
+
+  if (!it->status().ok()) {
+    logger(ERROR) << "DB Error. Can't read the default column family. Error: " << it->status().ToString();
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+  }
+
+  if (movedCount == 0) {
+    return;
+  }
+
+  rocksdb::Status status = db->Write(rocksdb::WriteOptions(), &batch);
+  if (!status.ok()) {
+    logger(ERROR) << "DB Error. Can't move keys to column families. Error: " << status.ToString();
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+  }
+
+  it.reset();
+
+  // reclaim the space of the moved keys
+  db->CompactRange(rocksdb::CompactRangeOptions(), columnFamilies[0], nullptr, nullptr);
+
+  logger(INFO) << "Moved " << movedCount << " keys to column families";
+}
+
 std::string RocksDBWrapper::getDataDir(const DataBaseConfig& config) {
   if (config.getTestnet()) {
     return config.getDataDir() + '/' + TESTNET_DB_NAME;
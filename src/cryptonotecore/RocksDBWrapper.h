@@ -17,11 +17,14 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rocksdb/db.h"
+#include "rocksdb/statistics.h"
 
 #include "IDataBase.h"
 #include "DataBaseConfig.h"
@@ -48,11 +51,31 @@ public:
   std::error_code write(IWriteBatch& batch) override;
   std::error_code read(IReadBatch& batch) override;
 
+  std::error_code createCheckpoint(const std::string& directory) override;
+
+  DataBaseStatistics getStatistics() const override;
+
+  static std::string getDataDir(const DataBaseConfig& config);
+
 private:
   std::error_code write(IWriteBatch& batch, bool sync);
 
   rocksdb::Options getDBOptions(const DataBaseConfig& config);
-  std::string getDataDir(const DataBaseConfig& config);
+  std::vector<rocksdb::ColumnFamilyDescriptor> getColumnFamilyDescriptors(const DataBaseConfig& config, const rocksdb::Options& dbOptions);
+
+  rocksdb::ColumnFamilyHandle* getColumnFamily(const std::string& key) const;
+  void moveKeysFromDefaultColumnFamily();
+
+  struct KeyCounters {
+    std::atomic<uint64_t> keysRead{0};
+    std::atomic<uint64_t> keysFound{0};
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> keysWritten{0};
+    std::atomic<uint64_t> keysRemoved{0};
+    std::atomic<uint64_t> bytesWritten{0};
+  };
+
+  KeyCounters& getKeyCounters(const std::string& key);
 
   enum State {
     NOT_INITIALIZED,
@@ -62,5 +85,19 @@ private:
   Logging::LoggerRef logger;
   std::unique_ptr<rocksdb::DB> db;
   std::atomic<State> state;
+
+  /* Owned by us, and must be released before the DB is */
+  std::vector<rocksdb::ColumnFamilyHandle*> columnFamilies;
+  /* Key prefix byte to the family holding those keys */
+  std::array<rocksdb::ColumnFamilyHandle*, 256> columnFamiliesByPrefix;
+
+  /* Read cache of every family without a share reserved, set by getDBOptions() */
+  std::shared_ptr<rocksdb::Cache> sharedBlockCache;
+
+  std::shared_ptr<rocksdb::Statistics> statistics;
+  std::atomic<uint64_t> readBatches;
+  std::atomic<uint64_t> writeBatches;
+  /* By key prefix byte, summed by family when asked for */
+  std::array<KeyCounters, 256> keyCounters;
 };
 }
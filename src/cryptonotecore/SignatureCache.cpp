@@ -0,0 +1,50 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "SignatureCache.h"
+
+#include <crypto/hash.h>
+
+namespace CryptoNote {
+
+SignatureCache::SignatureCache(size_t maxSize) : entries(maxSize) {
+}
+
+Crypto::Hash SignatureCache::getKey(const Crypto::Hash& transactionPrefixHash, const Crypto::KeyImage& keyImage,
+                                    const std::vector<Crypto::PublicKey>& outputKeys, const std::vector<Crypto::Signature>& signatures) {
+  std::vector<uint8_t> data;
+  data.reserve(sizeof(Crypto::Hash) + sizeof(Crypto::KeyImage) + outputKeys.size() * sizeof(Crypto::PublicKey) +
+               signatures.size() * sizeof(Crypto::Signature));
+
+  const auto append = [&data](const void* item, size_t size) {
+    const auto bytes = static_cast<const uint8_t*>(item);
+    data.insert(data.end(), bytes, bytes + size);
+  };
+
+  append(&transactionPrefixHash, sizeof(transactionPrefixHash));
+  append(&keyImage, sizeof(keyImage));
+  append(outputKeys.data(), outputKeys.size() * sizeof(Crypto::PublicKey));
+  append(signatures.data(), signatures.size() * sizeof(Crypto::Signature));
+
+  return Crypto::cn_fast_hash(data.data(), data.size());
+}
+
+bool SignatureCache::contains(const Crypto::Hash& key) {
+  bool unused;
+  return entries.get(key, unused);
+}
+
+void SignatureCache::insert(const Crypto::Hash& key) {
+  entries.insert(key, true);
+}
+
+uint64_t SignatureCache::getHits() const {
+  return entries.getHits();
+}
+
+uint64_t SignatureCache::getMisses() const {
+  return entries.getMisses();
+}
+
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <vector>
+
+#include <Common/ShardedLruCache.h>
+
+#include <crypto/crypto.h>
+
+namespace CryptoNote {
+
+/* Remembers ring signatures which have already been verified, so a
+   transaction checked on its way into the pool doesn't have its signatures
+   checked again when it arrives in a block. Only successful checks are
+   stored. Once full, the least recently checked entries are evicted first. */
+class SignatureCache {
+public:
+  explicit SignatureCache(size_t maxSize);
+
+  SignatureCache(const SignatureCache&) = delete;
+  SignatureCache& operator=(const SignatureCache&) = delete;
+
+  /* The signatures are part of the key, so a transaction with the same prefix
+     but different signatures is never treated as verified */
+  static Crypto::Hash getKey(const Crypto::Hash& transactionPrefixHash, const Crypto::KeyImage& keyImage,
+                             const std::vector<Crypto::PublicKey>& outputKeys, const std::vector<Crypto::Signature>& signatures);
+
+  bool contains(const Crypto::Hash& key);
+  void insert(const Crypto::Hash& key);
+
+  uint64_t getHits() const;
+  uint64_t getMisses() const;
+
+private:
+  /* Only the keys matter, the value is unused */
+  Common::ShardedLruCache<Crypto::Hash, bool> entries;
+};
+
+}
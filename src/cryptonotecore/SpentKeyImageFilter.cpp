@@ -0,0 +1,121 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "SpentKeyImageFilter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace CryptoNote {
+
+namespace {
+
+const uint32_t FILTER_FORMAT_VERSION = 1;
+
+/* 512 bit blocks, one cache line each */
+const size_t WORDS_PER_BLOCK = 8;
+const size_t BITS_PER_BLOCK = WORDS_PER_BLOCK * 64;
+
+/* ~0.2% false positives when the filter is at capacity */
+const size_t BITS_PER_KEY_IMAGE = 16;
+const size_t PROBES = 8;
+
+const size_t HEADER_SIZE = sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+}
+
+SpentKeyImageFilter::SpentKeyImageFilter(size_t capacity) :
+  capacity(capacity),
+  count(0),
+  blockCount(std::max<size_t>(1, capacity * BITS_PER_KEY_IMAGE / BITS_PER_BLOCK)),
+  words(blockCount * WORDS_PER_BLOCK, 0) {
+}
+
+/* Key images are curve points, so their bytes are already uniformly
+   distributed and can be used as the hashes directly */
+size_t SpentKeyImageFilter::getBlock(const Crypto::KeyImage& keyImage, uint64_t& h1, uint64_t& h2) const {
+  uint64_t h0;
+  std::memcpy(&h0, keyImage.data, sizeof(h0));
+  std::memcpy(&h1, keyImage.data + 8, sizeof(h1));
+  std::memcpy(&h2, keyImage.data + 16, sizeof(h2));
+
+  /* Odd step, so the probes don't repeat within a block */
+  h2 |= 1;
+
+  return static_cast<size_t>(h0 % blockCount) * WORDS_PER_BLOCK;
+}
+
+void SpentKeyImageFilter::insert(const Crypto::KeyImage& keyImage) {
+  uint64_t h1, h2;
+  const size_t block = getBlock(keyImage, h1, h2);
+
+  for (size_t i = 0; i < PROBES; ++i) {
+    const size_t bit = static_cast<size_t>((h1 + i * h2) % BITS_PER_BLOCK);
+    words[block + bit / 64] |= uint64_t(1) << (bit % 64);
+  }
+
+  ++count;
+}
+
+bool SpentKeyImageFilter::mayContain(const Crypto::KeyImage& keyImage) const {
+  uint64_t h1, h2;
+  const size_t block = getBlock(keyImage, h1, h2);
+
+  for (size_t i = 0; i < PROBES; ++i) {
+    const size_t bit = static_cast<size_t>((h1 + i * h2) % BITS_PER_BLOCK);
+    if ((words[block + bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t SpentKeyImageFilter::getCount() const {
+  return count;
+}
+
+size_t SpentKeyImageFilter::getCapacity() const {
+  return capacity;
+}
+
+std::string SpentKeyImageFilter::toBinary() const {
+  std::string data(HEADER_SIZE + words.size() * sizeof(uint64_t), '\0');
+  char* out = &data[0];
+
+  const uint64_t header[] = {capacity, count, blockCount};
+
+  std::memcpy(out, &FILTER_FORMAT_VERSION, sizeof(FILTER_FORMAT_VERSION));
+  std::memcpy(out + sizeof(FILTER_FORMAT_VERSION), header, sizeof(header));
+  std::memcpy(out + HEADER_SIZE, words.data(), words.size() * sizeof(uint64_t));
+
+  return data;
+}
+
+bool SpentKeyImageFilter::fromBinary(const std::string& data) {
+  if (data.size() < HEADER_SIZE) {
+    return false;
+  }
+
+  uint32_t version;
+  uint64_t header[3];
+
+  std::memcpy(&version, data.data(), sizeof(version));
+  std::memcpy(header, data.data() + sizeof(version), sizeof(header));
+
+  if (version != FILTER_FORMAT_VERSION || header[2] == 0 || data.size() != HEADER_SIZE + header[2] * WORDS_PER_BLOCK * sizeof(uint64_t)) {
+    return false;
+  }
+
+  capacity = static_cast<size_t>(header[0]);
+  count = static_cast<size_t>(header[1]);
+  blockCount = static_cast<size_t>(header[2]);
+
+  words.resize(blockCount * WORDS_PER_BLOCK);
+  std::memcpy(words.data(), data.data() + HEADER_SIZE, words.size() * sizeof(uint64_t));
+
+  return true;
+}
+
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <crypto/crypto.h>
+
+namespace CryptoNote {
+
+/* A blocked bloom filter over spent key images. Every key image maps to a
+   single 512 bit block, so a lookup touches one cache line. A negative
+   answer means the key image has definitely not been spent, so the
+   database only has to be asked about the (rare) positive answers.
+   Removing is not supported - a key image left behind by a split only
+   costs an extra database lookup. */
+class SpentKeyImageFilter {
+public:
+  explicit SpentKeyImageFilter(size_t capacity);
+
+  void insert(const Crypto::KeyImage& keyImage);
+  bool mayContain(const Crypto::KeyImage& keyImage) const;
+
+  /* Number of key images inserted */
+  size_t getCount() const;
+  /* Number of key images the filter was sized for */
+  size_t getCapacity() const;
+
+  std::string toBinary() const;
+  /* Returns false if the data is not a filter this version understands */
+  bool fromBinary(const std::string& data);
+
+private:
+  size_t getBlock(const Crypto::KeyImage& keyImage, uint64_t& h1, uint64_t& h2) const;
+
+  size_t capacity;
+  size_t count;
+  size_t blockCount;
+
+  std::vector<uint64_t> words;
+};
+
+}
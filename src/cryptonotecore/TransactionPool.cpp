@@ -72,6 +72,10 @@ bool TransactionPool::pushTransaction(CachedTransaction&& transaction, Transacti
 
   mergeStates(poolState, transactionState);
 
+  for (const auto& keyImage : transactionState.spentKeyImages) {
+    keyImageIndex.emplace(keyImage, pendingTx.getTransactionHash());
+  }
+
   logger(Logging::DEBUGGING) << "pushed transaction " << pendingTx.getTransactionHash() << " to pool";
   return transactionHashIndex.insert(std::move(pendingTx)).second;
 }
@@ -91,6 +95,13 @@ bool TransactionPool::removeTransaction(const Crypto::Hash& hash) {
   }
 
   excludeFromState(poolState, it->cachedTransaction);
+
+  for (const auto& input : it->cachedTransaction.getTransaction().inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      keyImageIndex.erase(boost::get<KeyInput>(input).keyImage);
+    }
+  }
+
   transactionHashIndex.erase(it);
 
   logger(Logging::DEBUGGING) << "transaction " << hash << " removed from pool";
@@ -172,4 +183,17 @@ std::vector<Crypto::Hash> TransactionPool::getTransactionHashesByPaymentId(const
   return transactionHashes;
 }
 
+std::vector<Crypto::Hash> TransactionPool::getTransactionHashesByKeyImages(const TransactionValidatorState& state) const {
+  std::unordered_set<Crypto::Hash> transactionHashes;
+
+  for (const auto& keyImage : state.spentKeyImages) {
+    auto it = keyImageIndex.find(keyImage);
+    if (it != keyImageIndex.end()) {
+      transactionHashes.insert(it->second);
+    }
+  }
+
+  return {transactionHashes.begin(), transactionHashes.end()};
+}
+
 }
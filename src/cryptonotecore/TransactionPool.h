@@ -40,9 +40,13 @@ public:
 
   virtual uint64_t getTransactionReceiveTime(const Crypto::Hash& hash) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
+  virtual std::vector<Crypto::Hash> getTransactionHashesByKeyImages(const TransactionValidatorState& state) const override;
 private:
   TransactionValidatorState poolState;
 
+  /* Which pool transaction spends each key image in poolState */
+  std::unordered_map<Crypto::KeyImage, Crypto::Hash> keyImageIndex;
+
   struct PendingTransactionInfo {
     uint64_t receiveTime;
     CachedTransaction cachedTransaction;
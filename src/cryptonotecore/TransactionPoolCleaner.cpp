@@ -76,6 +76,10 @@ std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesByPay
   return transactionPool->getTransactionHashesByPaymentId(paymentId);
 }
 
+std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesByKeyImages(const TransactionValidatorState& state) const {
+  return transactionPool->getTransactionHashesByKeyImages(state);
+}
+
 std::vector<Crypto::Hash> TransactionPoolCleanWrapper::clean(const uint32_t height) {
   try {
     uint64_t currentTime = timeProvider->now();
@@ -0,0 +1,20 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <Serialization/ISerializer.h>
+
+#include <WalletTypes.h>
+
+namespace CryptoNote {
+
+/* The wallet sync data is stored in the DB with these, as well as being
+   served over RPC, so changing them changes the DB format */
+void serialize(WalletTypes::WalletBlockInfo &walletBlockInfo, ISerializer &s);
+void serialize(WalletTypes::RawTransaction &rawTransaction, ISerializer &s);
+void serialize(WalletTypes::RawCoinbaseTransaction &rawCoinbaseTransaction, ISerializer &s);
+void serialize(WalletTypes::KeyOutput &keyOutput, ISerializer &s);
+
+}
@@ -306,13 +306,22 @@ bool CryptoNoteProtocolHandler::process_payload_sync_data(const CORE_SYNC_DATA&
     logger(logLevel, Logging::BRIGHT_GREEN) << context << ss.str();
 
     logger(Logging::DEBUGGING) << "Remote top block height: " << hshd.current_height << ", id: " << hshd.top_id;
-    //let the socket to send response to handshake, but request callback, to let send request data after response
-    logger(Logging::TRACE) << context << "requesting synchronization";
-    context.m_state = CryptoNoteConnectionContext::state_sync_required;
+
+    /* A pruned peer doesn't have the blocks we'd ask it for, we'll sync
+       from another and relay new blocks with this one */
+    if (hshd.pruned_height > currentHeight) {
+      logger(Logging::DEBUGGING) << context << "peer is pruned below height " << hshd.pruned_height << ", not syncing from it";
+      context.m_state = CryptoNoteConnectionContext::state_normal;
+    } else {
+      //let the socket to send response to handshake, but request callback, to let send request data after response
+      logger(Logging::TRACE) << context << "requesting synchronization";
+      context.m_state = CryptoNoteConnectionContext::state_sync_required;
+    }
   }
 
   updateObservedHeight(hshd.current_height, context);
   context.m_remote_blockchain_height = hshd.current_height;
+  context.m_remote_pruned_height = hshd.pruned_height;
 
   if (is_initial) {
     m_peersCount++;
@@ -325,6 +334,7 @@ bool CryptoNoteProtocolHandler::process_payload_sync_data(const CORE_SYNC_DATA&
 bool CryptoNoteProtocolHandler::get_payload_sync_data(CORE_SYNC_DATA& hshd) {
   hshd.top_id = m_core.getTopBlockHash();
   hshd.current_height = m_core.getTopBlockIndex() + 1;
+  hshd.pruned_height = m_core.getPrunedHeight();
   return true;
 }
 
@@ -395,6 +405,10 @@ int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_B
     } else {
       logger(Logging::TRACE) << context << "Block already exists";
     }
+  } else if (result == error::AddBlockErrorCondition::BLOCK_REJECTED
+             && context.m_remote_pruned_height > get_current_blockchain_height()) {
+    /* A pruned peer can't give us the blocks we're missing */
+    logger(Logging::DEBUGGING) << context << "peer is pruned below height " << context.m_remote_pruned_height << ", not syncing from it";
   } else if (result == error::AddBlockErrorCondition::BLOCK_REJECTED) {
     context.m_state = CryptoNoteConnectionContext::state_synchronizing;
     NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
@@ -534,6 +548,10 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     return 1;
   }
 
+  /* The proof of work hashes are by far the most expensive part of adding
+     these blocks, and don't depend on each other */
+  m_core.precalculateBlockLongHashes(cachedBlocks);
+
   {
     int result = processObjects(context, std::move(rawBlocks), cachedBlocks);
     if (result != 0) {
@@ -661,6 +679,10 @@ int CryptoNoteProtocolHandler::doPushLiteBlock(NOTIFY_NEW_LITE_BLOCK::request ar
             } else {
                 logger(Logging::TRACE) << context << "Block already exists";
             }
+        } else if (result == error::AddBlockErrorCondition::BLOCK_REJECTED
+                   && context.m_remote_pruned_height > get_current_blockchain_height()) {
+            /* A pruned peer can't give us the blocks we're missing */
+            logger(Logging::DEBUGGING) << context << "peer is pruned below height " << context.m_remote_pruned_height << ", not syncing from it";
         } else if (result == error::AddBlockErrorCondition::BLOCK_REJECTED) {
             context.m_state = CryptoNoteConnectionContext::state_synchronizing;
             NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
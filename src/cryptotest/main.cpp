@@ -2,9 +2,11 @@
 //
 // Please see the included LICENSE file for more information.
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <assert.h>
+#include <tuple>
 
 #include <cxxopts.hpp>
 #include <config/CliHeader.h>
@@ -13,6 +15,7 @@
 #include "CryptoTypes.h"
 #include "Common/StringTools.h"
 #include "crypto/crypto.h"
+#include "crypto/random.h"
 
 #define PERFORMANCE_ITERATIONS  1000
 #define PERFORMANCE_ITERATIONS_LONG_MULTIPLIER 10
@@ -174,6 +177,517 @@ void testHashFunction(
     }
 }
 
+/* Inputs for the multi-way hashes, which differ in their nonce */
+std::vector<BinaryArray> multiHashInputs(const size_t count)
+{
+    std::vector<BinaryArray> inputs(count, Common::fromHex(INPUT_DATA));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        inputs[i][39] ^= static_cast<uint8_t>(i);
+    }
+
+    return inputs;
+}
+
+void testMultiHash()
+{
+    for (size_t ways = 1; ways <= Crypto::SLOW_HASH_MAX_WAYS; ways++)
+    {
+        const std::vector<BinaryArray> inputs = multiHashInputs(ways);
+
+        std::vector<const void *> data;
+        std::vector<size_t> lengths;
+        std::vector<Hash> hashes(ways);
+        std::vector<Hash *> hashPointers;
+
+        for (size_t i = 0; i < ways; i++)
+        {
+            data.push_back(inputs[i].data());
+            lengths.push_back(inputs[i].size());
+            hashPointers.push_back(&hashes[i]);
+        }
+
+        cn_turtle_lite_slow_hash_v2_multi(data.data(), lengths.data(), hashPointers.data(), ways);
+
+        for (size_t i = 0; i < ways; i++)
+        {
+            Hash expected = Hash();
+            cn_turtle_lite_slow_hash_v2(inputs[i].data(), inputs[i].size(), expected);
+
+            if (hashes[i] != expected)
+            {
+                std::cout << "Hash " << i << " of " << ways << "-way cn_turtle_lite_slow_hash_v2_multi is not equal!\n"
+                          << "Expected: " << expected << "\nActual: " << hashes[i] << "\nTerminating.";
+
+                exit(1);
+            }
+        }
+    }
+
+    std::cout << "cn_turtle_lite_slow_hash_v2_multi: matches cn_turtle_lite_slow_hash_v2 for 1 to "
+              << Crypto::SLOW_HASH_MAX_WAYS << " ways" << std::endl;
+}
+
+std::string fieldBackendName(const FieldBackend backend)
+{
+    return backend == FieldBackend::Radix51 ? "radix 2^51" : "ref10";
+}
+
+/* Everything which goes through the scalar multiplications, for random
+   keys, so it can be run on each field backend and compared */
+struct FieldBackendResults
+{
+    Crypto::PublicKey publicKey;
+    Crypto::KeyDerivation derivation;
+    Crypto::PublicKey derivedKey;
+    Crypto::PublicKey underivedKey;
+    Crypto::KeyImage keyImage;
+    Crypto::KeyImage scalarmultKey;
+    bool validSignature;
+    bool invalidSignature;
+    bool validRingSignature;
+    bool invalidRingSignature;
+
+    bool operator==(const FieldBackendResults &other) const
+    {
+        return publicKey == other.publicKey
+            && derivation == other.derivation
+            && derivedKey == other.derivedKey
+            && underivedKey == other.underivedKey
+            && keyImage == other.keyImage
+            && scalarmultKey == other.scalarmultKey
+            && validSignature == other.validSignature
+            && invalidSignature == other.invalidSignature
+            && validRingSignature == other.validRingSignature
+            && invalidRingSignature == other.invalidRingSignature;
+    }
+};
+
+void testFieldBackends(const uint64_t rounds)
+{
+    if (!Crypto::crypto_ops::isFieldBackendAvailable(FieldBackend::Radix51))
+    {
+        std::cout << "Field backends: only ref10 is available, nothing to compare" << std::endl;
+        return;
+    }
+
+    const FieldBackend originalBackend = Crypto::crypto_ops::getFieldBackend();
+
+    for (uint64_t i = 0; i < rounds; i++)
+    {
+        Crypto::PublicKey spendPublicKey, txPublicKey;
+        Crypto::SecretKey spendSecretKey, txSecretKey;
+
+        Crypto::generate_keys(spendPublicKey, spendSecretKey);
+        Crypto::generate_keys(txPublicKey, txSecretKey);
+
+        Crypto::Hash prefixHash;
+        Crypto::cn_fast_hash(&i, sizeof(i), prefixHash);
+
+        /* Signing picks a random nonce, so signatures are made once and
+           only checked on each backend */
+        Crypto::Signature signature;
+        Crypto::generate_signature(prefixHash, spendPublicKey, spendSecretKey, signature);
+
+        Crypto::KeyImage keyImage;
+        Crypto::generate_key_image(spendPublicKey, spendSecretKey, keyImage);
+
+        const std::vector<Crypto::PublicKey> ring = {txPublicKey, spendPublicKey};
+
+        const auto [success, ringSignatures] = Crypto::crypto_ops::generateRingSignatures(
+            prefixHash, keyImage, ring, spendSecretKey, 1
+        );
+
+        std::vector<Crypto::Signature> invalidRingSignatures = ringSignatures;
+        invalidRingSignatures[0].data[0] ^= 1;
+
+        FieldBackendResults results[2];
+
+        for (const FieldBackend backend : {FieldBackend::Ref10, FieldBackend::Radix51})
+        {
+            FieldBackendResults &result = results[static_cast<int>(backend)];
+
+            Crypto::crypto_ops::setFieldBackend(backend);
+
+            Crypto::secret_key_to_public_key(spendSecretKey, result.publicKey);
+            Crypto::generate_key_derivation(txPublicKey, spendSecretKey, result.derivation);
+            Crypto::derive_public_key(result.derivation, i, spendPublicKey, result.derivedKey);
+            Crypto::underive_public_key(result.derivation, i, result.derivedKey, result.underivedKey);
+            Crypto::generate_key_image(txPublicKey, spendSecretKey, result.keyImage);
+
+            result.scalarmultKey = Crypto::scalarmultKey(
+                reinterpret_cast<const Crypto::KeyImage &>(txPublicKey),
+                reinterpret_cast<const Crypto::KeyImage &>(spendSecretKey)
+            );
+
+            result.validSignature = Crypto::check_signature(prefixHash, spendPublicKey, signature);
+            result.invalidSignature = Crypto::check_signature(prefixHash, txPublicKey, signature);
+
+            result.validRingSignature = Crypto::crypto_ops::checkRingSignature(prefixHash, keyImage, ring, ringSignatures);
+            result.invalidRingSignature = Crypto::crypto_ops::checkRingSignature(prefixHash, keyImage, ring, invalidRingSignatures);
+        }
+
+        const FieldBackendResults &ref10 = results[static_cast<int>(FieldBackend::Ref10)];
+
+        if (!(ref10 == results[static_cast<int>(FieldBackend::Radix51)])
+         || !success || ref10.underivedKey != spendPublicKey || !ref10.validSignature || ref10.invalidSignature
+         || !ref10.validRingSignature || ref10.invalidRingSignature)
+        {
+            std::cout << "Field backends disagree for spend key " << spendSecretKey << " and transaction key "
+                      << txSecretKey << "!\nTerminating.";
+
+            exit(1);
+        }
+    }
+
+    Crypto::crypto_ops::setFieldBackend(originalBackend);
+
+    std::cout << "Field backends: ref10 and radix 2^51 agree over " << rounds << " rounds, using "
+              << fieldBackendName(originalBackend) << std::endl;
+}
+
+/* Points an attacker can put in a transaction: the points of small order,
+   non canonical encodings, which decode to a y of p or above, and points
+   whose y has its 51 bit limbs all set or all clear */
+std::vector<Crypto::PublicKey> adversarialPoints()
+{
+    std::vector<std::string> encodings = {
+        /* Small order, with and without the sign bit */
+        "0100000000000000000000000000000000000000000000000000000000000000",
+        "0100000000000000000000000000000000000000000000000000000000000080",
+        "ecffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff7f",
+        "ecffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+        "0000000000000000000000000000000000000000000000000000000000000000",
+        "0000000000000000000000000000000000000000000000000000000000000080",
+        "c7176a703d4dd84fba3c0b760d10670f2a2053fa2c39ccc64ec7fd7792ac037a",
+        "c7176a703d4dd84fba3c0b760d10670f2a2053fa2c39ccc64ec7fd7792ac03fa",
+        "26e8958fc2b227b045c3f489f2ef98f0d5dfac05d3c63339b13802886d53fc05",
+        "26e8958fc2b227b045c3f489f2ef98f0d5dfac05d3c63339b13802886d53fc85"
+    };
+
+    std::vector<Crypto::PublicKey> points;
+
+    for (const auto &encoding : encodings)
+    {
+        Crypto::PublicKey point;
+        Common::podFromHex(encoding, point);
+        points.push_back(point);
+    }
+
+    /* y from p to 2^255 - 1 */
+    for (uint8_t low = 0xed; low != 0; low++)
+    {
+        Crypto::PublicKey point;
+        std::fill(std::begin(point.data), std::end(point.data), 0xff);
+        point.data[0] = low;
+        point.data[31] = 0x7f;
+        points.push_back(point);
+
+        point.data[31] = 0xff;
+        points.push_back(point);
+    }
+
+    /* Runs of whole limbs set, nudged until they're on the curve */
+    for (int start = 0; start < 255; start += 51)
+    {
+        for (int end = start + 51; end <= 255; end += 51)
+        {
+            for (const bool invert : {false, true})
+            {
+                Crypto::PublicKey point;
+
+                for (int bit = 0; bit < 256; bit++)
+                {
+                    const bool set = (bit >= start && bit < end) != invert && bit < 255;
+
+                    if (set)
+                    {
+                        point.data[bit / 8] |= 1 << (bit % 8);
+                    }
+                    else
+                    {
+                        point.data[bit / 8] &= ~(1 << (bit % 8));
+                    }
+                }
+
+                for (int nudge = 0; nudge < 64; nudge++)
+                {
+                    if (Crypto::check_key(point))
+                    {
+                        points.push_back(point);
+                        point.data[31] ^= 0x80;
+                        points.push_back(point);
+                        break;
+                    }
+
+                    point.data[0] ^= static_cast<uint8_t>(nudge + 1);
+                }
+            }
+        }
+    }
+
+    return points;
+}
+
+/* Scalars at the edges of the scalar recoding, and above the group order */
+std::vector<Crypto::KeyImage> adversarialScalars()
+{
+    const std::vector<std::string> encodings = {
+        "0000000000000000000000000000000000000000000000000000000000000000",
+        "0100000000000000000000000000000000000000000000000000000000000000",
+        "0800000000000000000000000000000000000000000000000000000000000000",
+        /* l - 1, l and l + 1 */
+        "ecd3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010",
+        "edd3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010",
+        "eed3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010",
+        "0000000000000000000000000000000000000000000000000000000000000010",
+        "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff0f",
+        "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff7f",
+        "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+        "0000000000000000000000000000000000000000000000000000000000000080",
+        "8888888888888888888888888888888888888888888888888888888888888808",
+        "7777777777777777777777777777777777777777777777777777777777777707",
+        "f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f000",
+        "0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f"
+    };
+
+    std::vector<Crypto::KeyImage> scalars;
+
+    for (const auto &encoding : encodings)
+    {
+        Crypto::KeyImage scalar;
+        Common::podFromHex(encoding, scalar);
+        scalars.push_back(scalar);
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        Crypto::KeyImage scalar;
+        Random::randomBytes(sizeof(scalar.data), scalar.data);
+        scalars.push_back(scalar);
+    }
+
+    return scalars;
+}
+
+/* The results of everything which goes through the scalar multiplications,
+   for the adversarial points and scalars, on the current field backend */
+std::vector<std::string> adversarialResults(
+    const std::vector<Crypto::PublicKey> &points,
+    const std::vector<Crypto::KeyImage> &scalars,
+    const std::vector<Crypto::Signature> &signatures,
+    const std::vector<std::tuple<Crypto::Hash, std::vector<Crypto::PublicKey>, std::vector<Crypto::Signature>>> &rings)
+{
+    std::vector<std::string> results;
+
+    const auto record = [&results](const std::string &operation, const auto &result)
+    {
+        results.push_back(operation + ": " + Common::podToHex(result));
+    };
+
+    Crypto::Hash prefixHash;
+    Crypto::cn_fast_hash("adversarial", 11, prefixHash);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const Crypto::PublicKey &point = points[i];
+        const std::string pointName = "point " + Common::podToHex(point);
+
+        if (!Crypto::check_key(point))
+        {
+            continue;
+        }
+
+        for (const auto &scalar : scalars)
+        {
+            const std::string name = pointName + ", scalar " + Common::podToHex(scalar);
+
+            /* Any 32 bytes, as with the scalarmultKey calls on key images */
+            record(name + ", scalarmultKey", Crypto::scalarmultKey(reinterpret_cast<const Crypto::KeyImage &>(point), scalar));
+
+            const Crypto::SecretKey &secretKey = reinterpret_cast<const Crypto::SecretKey &>(scalar);
+            Crypto::PublicKey publicKey;
+
+            /* The rest need a reduced scalar */
+            if (!Crypto::secret_key_to_public_key(secretKey, publicKey))
+            {
+                continue;
+            }
+
+            record(name + ", secret_key_to_public_key", publicKey);
+
+            Crypto::KeyDerivation derivation;
+            record(name + ", generate_key_derivation", Crypto::generate_key_derivation(point, secretKey, derivation));
+            record(name + ", derivation", derivation);
+
+            Crypto::PublicKey derivedKey, underivedKey;
+            record(name + ", derive_public_key", Crypto::derive_public_key(derivation, i, point, derivedKey));
+            record(name + ", derived key", derivedKey);
+            record(name + ", underive_public_key", Crypto::underive_public_key(derivation, i, point, underivedKey));
+            record(name + ", underived key", underivedKey);
+
+            Crypto::KeyImage keyImage;
+            Crypto::generate_key_image(point, secretKey, keyImage);
+            record(name + ", generate_key_image", keyImage);
+        }
+
+        for (const auto &signature : signatures)
+        {
+            record(pointName + ", signature " + Common::podToHex(signature) + ", check_signature",
+                   Crypto::check_signature(prefixHash, point, signature));
+        }
+
+        /* The point as the key image, many of them outside the subgroup,
+           and as a ring member */
+        for (const auto &[ringPrefixHash, ring, ringSignatures] : rings)
+        {
+            const Crypto::KeyImage &keyImage = reinterpret_cast<const Crypto::KeyImage &>(point);
+
+            record(pointName + ", checkRingSignature as key image",
+                   Crypto::crypto_ops::checkRingSignature(ringPrefixHash, keyImage, ring, ringSignatures));
+
+            Crypto::RingCheck check {&ringPrefixHash, &keyImage, &ring, &ringSignatures};
+
+            record(pointName + ", checkRingSignatures as key image",
+                   static_cast<bool>(Crypto::crypto_ops::checkRingSignatures({&check, 1})[0]));
+        }
+    }
+
+    return results;
+}
+
+/* The field backends must agree on everything an attacker can throw at
+   them, not only on honest keys, or nodes on different backends would
+   disagree on which transactions are valid */
+void testFieldBackendsAdversarial()
+{
+    if (!Crypto::crypto_ops::isFieldBackendAvailable(FieldBackend::Radix51))
+    {
+        std::cout << "Field backends: only ref10 is available, nothing to compare" << std::endl;
+        return;
+    }
+
+    const FieldBackend originalBackend = Crypto::crypto_ops::getFieldBackend();
+
+    Crypto::crypto_ops::setFieldBackend(FieldBackend::Ref10);
+
+    std::vector<Crypto::PublicKey> points = adversarialPoints();
+    const std::vector<Crypto::KeyImage> scalars = adversarialScalars();
+
+    /* Honest points with a point of small order added, so outside the
+       prime order subgroup */
+    Crypto::KeyDerivation derivation;
+    Random::randomBytes(sizeof(derivation.data), derivation.data);
+
+    for (size_t i = 0; i < 10; i++)
+    {
+        Crypto::PublicKey offSubgroup;
+
+        if (Crypto::derive_public_key(derivation, i, points[i], offSubgroup))
+        {
+            points.push_back(offSubgroup);
+        }
+    }
+
+    /* Signatures made of the scalars which are reduced */
+    std::vector<Crypto::Signature> signatures;
+
+    for (size_t i = 0; i + 1 < scalars.size(); i++)
+    {
+        Crypto::Signature signature;
+        std::copy(std::begin(scalars[i].data), std::end(scalars[i].data), signature.data);
+        std::copy(std::begin(scalars[i + 1].data), std::end(scalars[i + 1].data), signature.data + 32);
+        signatures.push_back(signature);
+    }
+
+    /* Valid ring signatures, with every adversarial point as a decoy */
+    std::vector<std::tuple<Crypto::Hash, std::vector<Crypto::PublicKey>, std::vector<Crypto::Signature>>> rings;
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        if (!Crypto::check_key(points[i]))
+        {
+            continue;
+        }
+
+        Crypto::PublicKey publicKey;
+        Crypto::SecretKey secretKey;
+        Crypto::generate_keys(publicKey, secretKey);
+
+        Crypto::KeyImage keyImage;
+        Crypto::generate_key_image(publicKey, secretKey, keyImage);
+
+        Crypto::Hash prefixHash;
+        Crypto::cn_fast_hash(&i, sizeof(i), prefixHash);
+
+        const std::vector<Crypto::PublicKey> ring = {points[i], publicKey};
+
+        const auto [success, ringSignatures] = Crypto::crypto_ops::generateRingSignatures(
+            prefixHash, keyImage, ring, secretKey, 1
+        );
+
+        if (!success || !Crypto::crypto_ops::checkRingSignature(prefixHash, keyImage, ring, ringSignatures))
+        {
+            continue;
+        }
+
+        /* Only a few are needed to go with every point as the key image */
+        if (rings.size() < 4)
+        {
+            rings.emplace_back(prefixHash, ring, ringSignatures);
+        }
+
+        /* Checked for each backend below with the honest key image */
+        std::vector<std::string> results[2];
+
+        for (const FieldBackend backend : {FieldBackend::Ref10, FieldBackend::Radix51})
+        {
+            Crypto::crypto_ops::setFieldBackend(backend);
+
+            Crypto::RingCheck check {&prefixHash, &keyImage, &ring, &ringSignatures};
+
+            results[static_cast<int>(backend)].push_back(std::to_string(
+                Crypto::crypto_ops::checkRingSignature(prefixHash, keyImage, ring, ringSignatures)
+             && Crypto::crypto_ops::checkRingSignatures({&check, 1})[0]
+            ));
+        }
+
+        if (results[0] != results[1] || results[0][0] != "1")
+        {
+            std::cout << "Field backends disagree on a ring signature with decoy " << points[i] << "!\nTerminating.";
+            exit(1);
+        }
+    }
+
+    std::vector<std::string> results[2];
+
+    for (const FieldBackend backend : {FieldBackend::Ref10, FieldBackend::Radix51})
+    {
+        Crypto::crypto_ops::setFieldBackend(backend);
+        results[static_cast<int>(backend)] = adversarialResults(points, scalars, signatures, rings);
+    }
+
+    Crypto::crypto_ops::setFieldBackend(originalBackend);
+
+    const auto &ref10 = results[static_cast<int>(FieldBackend::Ref10)];
+    const auto &radix51 = results[static_cast<int>(FieldBackend::Radix51)];
+
+    for (size_t i = 0; i < ref10.size(); i++)
+    {
+        if (ref10[i] != radix51[i])
+        {
+            std::cout << "Field backends disagree on adversarial input!\nref10: " << ref10[i]
+                      << "\nradix 2^51: " << radix51[i] << "\nTerminating.";
+
+            exit(1);
+        }
+    }
+
+    std::cout << "Field backends: ref10 and radix 2^51 agree on " << ref10.size() << " results for "
+              << points.size() << " adversarial points and " << scalars.size() << " scalars" << std::endl;
+}
+
 /* Bit of hackery so we can get the variable name of the passed in function.
    This way we can print the test we are currently performing. */
 #define BENCHMARK(hashFunction, iterations) \
@@ -205,6 +719,82 @@ void benchmark(T hashFunction, std::string hashFunctionName, uint64_t iterations
               << " H/s\n";
 }
 
+void benchmarkMultiHash(const uint64_t iterations)
+{
+    for (const size_t ways : {1, 2, 4})
+    {
+        const std::vector<BinaryArray> inputs = multiHashInputs(ways);
+
+        std::vector<const void *> data;
+        std::vector<size_t> lengths;
+        std::vector<Hash> hashes(ways);
+        std::vector<Hash *> hashPointers;
+
+        for (size_t i = 0; i < ways; i++)
+        {
+            data.push_back(inputs[i].data());
+            lengths.push_back(inputs[i].size());
+            hashPointers.push_back(&hashes[i]);
+        }
+
+        uint64_t hashCount = 0;
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (; hashCount < iterations; hashCount += ways)
+        {
+            cn_turtle_lite_slow_hash_v2_multi(data.data(), lengths.data(), hashPointers.data(), ways);
+        }
+
+        auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        const double seconds = std::chrono::duration<double>(elapsedTime).count();
+
+        std::cout << "cn_turtle_lite_slow_hash_v2_multi (" << ways << "-way): "
+                  << static_cast<uint64_t>(hashCount / seconds) << " H/s per thread\n";
+    }
+}
+
+void benchmarkScratchpadModes(const uint64_t iterations)
+{
+    const BinaryArray& rawData = Common::fromHex(INPUT_DATA);
+
+    for (const int mode : {SLOW_HASH_SCRATCHPAD_HUGE_PAGES, SLOW_HASH_SCRATCHPAD_TRANSPARENT_HUGE_PAGES, SLOW_HASH_SCRATCHPAD_PLAIN})
+    {
+        slow_hash_set_scratchpad_mode(mode);
+
+        Hash hash = Hash();
+
+        /* Allocates the scratchpad, so we know if we got the mode */
+        cn_turtle_lite_slow_hash_v2(rawData.data(), rawData.size(), hash);
+
+        if (slow_hash_get_scratchpad_mode() != mode)
+        {
+            std::cout << "cn_turtle_lite_slow_hash_v2 with " << slow_hash_scratchpad_mode_name(mode)
+                      << ": not available\n";
+
+            continue;
+        }
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            cn_turtle_lite_slow_hash_v2(rawData.data(), rawData.size(), hash);
+        }
+
+        auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        const double seconds = std::chrono::duration<double>(elapsedTime).count();
+
+        std::cout << "cn_turtle_lite_slow_hash_v2 with " << slow_hash_scratchpad_mode_name(mode) << ": "
+                  << static_cast<uint64_t>(iterations / seconds) << " H/s\n";
+    }
+
+    /* Back to the default, trying the best mode first */
+    slow_hash_set_scratchpad_mode(SLOW_HASH_SCRATCHPAD_HUGE_PAGES);
+}
+
 void benchmarkUnderivePublicKey()
 {
     Crypto::KeyDerivation derivation;
@@ -266,6 +856,146 @@ void benchmarkGenerateKeyDerivation()
     std::cout << "Time to perform generateKeyDerivation: " << timePerDerivation / 1000.0 << " ms" << std::endl;
 }
 
+void benchmarkFieldBackends()
+{
+    Crypto::PublicKey publicKey;
+    Crypto::SecretKey secretKey;
+    Crypto::generate_keys(publicKey, secretKey);
+
+    Crypto::Hash prefixHash = Crypto::Hash();
+
+    Crypto::Signature signature;
+    Crypto::generate_signature(prefixHash, publicKey, secretKey, signature);
+
+    const FieldBackend originalBackend = Crypto::crypto_ops::getFieldBackend();
+
+    const uint64_t loopIterations = 20000;
+
+    for (const FieldBackend backend : {FieldBackend::Ref10, FieldBackend::Radix51})
+    {
+        if (!Crypto::crypto_ops::setFieldBackend(backend))
+        {
+            continue;
+        }
+
+        Crypto::KeyDerivation derivation;
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < loopIterations; i++)
+        {
+            Crypto::generate_key_derivation(publicKey, secretKey, derivation);
+            Crypto::check_signature(prefixHash, publicKey, signature);
+        }
+
+        auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        const auto timePerLoop = std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / loopIterations;
+
+        std::cout << "Time to perform generateKeyDerivation and check_signature with " << fieldBackendName(backend)
+                  << ": " << timePerLoop / 1000.0 << " ms" << std::endl;
+    }
+
+    Crypto::crypto_ops::setFieldBackend(originalBackend);
+}
+
+void benchmarkCheckRingSignatures()
+{
+    /* A block's worth of inputs, each with a ring of 4 */
+    const size_t inputCount = 64;
+    const size_t ringSize = 4;
+
+    std::vector<Crypto::Hash> prefixHashes(inputCount);
+    std::vector<Crypto::KeyImage> keyImages(inputCount);
+    std::vector<std::vector<Crypto::PublicKey>> publicKeys(inputCount, std::vector<Crypto::PublicKey>(ringSize));
+    std::vector<std::vector<Crypto::Signature>> signatures(inputCount);
+
+    std::vector<Crypto::RingCheck> checks;
+
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        Crypto::SecretKey secretKey;
+
+        for (auto &publicKey : publicKeys[i])
+        {
+            Crypto::generate_keys(publicKey, secretKey);
+        }
+
+        /* The last key generated is the one being spent */
+        Crypto::generate_key_image(publicKeys[i].back(), secretKey, keyImages[i]);
+
+        Crypto::cn_fast_hash(&i, sizeof(i), prefixHashes[i]);
+
+        std::tie(std::ignore, signatures[i]) = Crypto::crypto_ops::generateRingSignatures(
+            prefixHashes[i], keyImages[i], publicKeys[i], secretKey, ringSize - 1
+        );
+
+        checks.push_back({&prefixHashes[i], &keyImages[i], &publicKeys[i], &signatures[i]});
+    }
+
+    const uint64_t loopIterations = 50;
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t j = 0; j < loopIterations; j++)
+    {
+        for (size_t i = 0; i < inputCount; i++)
+        {
+            if (!Crypto::crypto_ops::checkRingSignature(prefixHashes[i], keyImages[i], publicKeys[i], signatures[i]))
+            {
+                throw std::runtime_error("checkRingSignature failed on a valid signature");
+            }
+        }
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    const auto timePerInput = std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / (loopIterations * inputCount);
+
+    std::cout << "Time to perform checkRingSignature: " << timePerInput / 1000.0 << " ms per input" << std::endl;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t j = 0; j < loopIterations; j++)
+    {
+        const std::vector<bool> results = Crypto::crypto_ops::checkRingSignatures({checks.data(), checks.size()});
+
+        if (std::find(results.begin(), results.end(), false) != results.end())
+        {
+            throw std::runtime_error("checkRingSignatures failed on a valid signature");
+        }
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    const auto timePerBatchedInput = std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / (loopIterations * inputCount);
+
+    std::cout << "Time to perform checkRingSignatures: " << timePerBatchedInput / 1000.0 << " ms per input" << std::endl;
+
+    /* Every ring member is seen again each iteration, so after the first
+       they should all come from the cache, given room to spare */
+    Crypto::crypto_ops::setPointCacheSize(inputCount * ringSize * 4);
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t j = 0; j < loopIterations; j++)
+    {
+        Crypto::crypto_ops::checkRingSignatures({checks.data(), checks.size()});
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    const auto timePerCachedInput = std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / (loopIterations * inputCount);
+
+    const Crypto::PointCacheStatistics stats = Crypto::crypto_ops::getPointCacheStatistics();
+
+    std::cout << "Time to perform checkRingSignatures with point cache: " << timePerCachedInput / 1000.0 << " ms per input ("
+              << stats.hits << " hits, " << stats.misses << " misses, "
+              << (100.0 * stats.hits / std::max<uint64_t>(stats.hits + stats.misses, 1)) << "% hit rate)" << std::endl;
+
+    Crypto::crypto_ops::setPointCacheSize(0);
+}
+
 int main(int argc, char** argv)
 {
     bool o_help, o_version, o_benchmark;
@@ -352,6 +1082,11 @@ int main(int argc, char** argv)
         TEST_HASH_FUNCTION(cn_turtle_lite_slow_hash_v1, CN_TURTLE_LITE_SLOW_HASH_V1);
         TEST_HASH_FUNCTION(cn_turtle_lite_slow_hash_v2, CN_TURTLE_LITE_SLOW_HASH_V2);
 
+        testMultiHash();
+
+        std::cout << "Slow hash scratchpad: " << slow_hash_scratchpad_mode_name(slow_hash_get_scratchpad_mode())
+                  << std::endl;
+
         std::cout << std::endl;
 
         for (uint64_t height = 0; height <= 8192; height += 512)
@@ -373,12 +1108,19 @@ int main(int argc, char** argv)
             TEST_HASH_FUNCTION_WITH_HEIGHT(cn_soft_shell_slow_hash_v2, CN_SOFT_SHELL_V2[height / 512], height);
         }
 
+        std::cout << std::endl;
+
+        testFieldBackends(200);
+        testFieldBackendsAdversarial();
+
         if (o_benchmark)
         {
             std::cout <<  "\nPerformance Tests: Please wait, this may take a while depending on your system...\n\n";
 
             benchmarkUnderivePublicKey();
             benchmarkGenerateKeyDerivation();
+            benchmarkCheckRingSignatures();
+            benchmarkFieldBackends();
 
             BENCHMARK(cn_slow_hash_v0, o_iterations);
             BENCHMARK(cn_slow_hash_v1, o_iterations);
@@ -403,6 +1145,9 @@ int main(int argc, char** argv)
             BENCHMARK(cn_turtle_lite_slow_hash_v0, o_iterations_long);
             BENCHMARK(cn_turtle_lite_slow_hash_v1, o_iterations_long);
             BENCHMARK(cn_turtle_lite_slow_hash_v2, o_iterations_long);
+
+            benchmarkMultiHash(o_iterations_long);
+            benchmarkScratchpadModes(o_iterations_long);
         }
     }
     catch (std::exception& e)
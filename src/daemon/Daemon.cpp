@@ -16,16 +16,20 @@
 #include "Common/PathTools.h"
 #include "Common/Util.h"
 #include "Common/FileSystemShim.h"
+#include "crypto/crypto.h"
 #include "crypto/hash.h"
 #include "Common/CryptoNoteTools.h"
 #include "CryptoNoteCore/Core.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/DatabaseBlockchainCache.h"
 #include "CryptoNoteCore/DatabaseBlockchainCacheFactory.h"
+#include "CryptoNoteCore/GroupCommitDataBase.h"
 #include "CryptoNoteCore/MainChainStorage.h"
+#include "CryptoNoteCore/MainChainStorageMmap.h"
 #include "CryptoNoteCore/MainChainStorageSqlite.h"
 #include "CryptoNoteCore/MainChainStorageRocksdb.h"
 #include "CryptoNoteCore/RocksDBWrapper.h"
+#include "CryptoNoteCore/Snapshot.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
 #include "P2p/NetNode.h"
 #include "P2p/NetNodeConfig.h"
@@ -202,6 +206,7 @@ int main(int argc, char* argv[])
       config.dataDirectory + "/" + CryptoNote::parameters::P2P_NET_DATA_FILENAME,
       config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCKS_FILENAME + ".sqlite3",
       config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCKS_FILENAME + ".rocksdb",
+      config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCKS_FILENAME + ".mmap",
       config.dataDirectory + "/DB"
     };
 
@@ -262,31 +267,59 @@ int main(int argc, char* argv[])
       config.enableDbCompression
     );
 
-    /* If we were told to rewind the blockchain to a certain height
-       we will remove blocks until we're back at the height specified */
-    if (config.rewindToHeight > 0)
+    for (const auto& columnFamily : config.dbColumnFamilies)
     {
-      logger(INFO) << "Rewinding blockchain to: " << config.rewindToHeight << std::endl;
-      std::unique_ptr<IMainChainStorage> mainChainStorage;
+      if (!dbConfig.setColumnFamilyOptions(columnFamily))
+      {
+        logger(ERROR, BRIGHT_RED) << "Invalid column family tuning '" << columnFamily << "', expected <name>:<setting>=<value>,... "
+                                  << "naming a known family and setting, with cache shares adding up to no more than 100";
+        return 1;
+      }
+    }
 
+    /* Opens the main chain storage backend we were told to use */
+    const auto createMainChainStorage = [&config, &currency, &dbConfig]() -> std::unique_ptr<IMainChainStorage>
+    {
       if (config.useSqliteForLocalCaches)
       {
-        mainChainStorage = createSwappedMainChainStorageSqlite(config.dataDirectory, currency);
+        return createSwappedMainChainStorageSqlite(config.dataDirectory, currency, config.enableDbCompression);
       }
-      else if (config.useRocksdbForLocalCaches )
+      else if (config.useRocksdbForLocalCaches)
       {
-        mainChainStorage = createSwappedMainChainStorageRocksdb(config.dataDirectory, currency, dbConfig);
+        return createSwappedMainChainStorageRocksdb(config.dataDirectory, currency, dbConfig);
       }
-      else
+      else if (config.useMmapForLocalCaches)
       {
-        mainChainStorage = createSwappedMainChainStorage(config.dataDirectory, currency);
+        return createSwappedMainChainStorageMmap(config.dataDirectory, currency, config.enableDbCompression);
       }
 
+      return createSwappedMainChainStorage(config.dataDirectory, currency);
+    };
+
+    /* If we were told to rewind the blockchain to a certain height
+       we will remove blocks until we're back at the height specified */
+    if (config.rewindToHeight > 0)
+    {
+      logger(INFO) << "Rewinding blockchain to: " << config.rewindToHeight << std::endl;
+      std::unique_ptr<IMainChainStorage> mainChainStorage = createMainChainStorage();
+
       mainChainStorage->rewindTo(config.rewindToHeight);
 
       logger(INFO) << "Blockchain rewound to: " << config.rewindToHeight << std::endl;
     }
 
+    /* If we were told to migrate the local blockchain cache, rewrite any
+       blocks stored in the json format of older versions in binary */
+    if (config.migrateRawBlocks)
+    {
+      logger(INFO) << "Migrating local blockchain cache to the binary block format..." << std::endl;
+      std::unique_ptr<IMainChainStorage> mainChainStorage = createMainChainStorage();
+
+      const uint32_t migrated = mainChainStorage->migrateRawBlocks();
+
+      logger(INFO) << "Migrated " << migrated << " blocks" << std::endl;
+    }
+
     bool use_checkpoints = !config.checkPoints.empty();
     CryptoNote::Checkpoints checkpoints(logManager);
 
@@ -320,6 +353,24 @@ int main(int argc, char* argv[])
       throw std::runtime_error("Can't create directory: " + dbConfig.getDataDir());
     }
 
+    /* If we were given a snapshot, replace the blockchain data with it
+       before the database is opened */
+    if (!config.loadSnapshot.empty())
+    {
+      logger(INFO) << "Loading snapshot from " << config.loadSnapshot << ", this may take a while..." << std::endl;
+      std::unique_ptr<IMainChainStorage> mainChainStorage = createMainChainStorage();
+
+      const SnapshotManifest manifest = loadSnapshot(
+        config.loadSnapshot,
+        RocksDBWrapper::getDataDir(dbConfig),
+        *mainChainStorage,
+        checkpoints
+      );
+
+      logger(INFO) << "Loaded snapshot of " << manifest.blockCount << " blocks, top block " << manifest.topHash << std::endl;
+      logger(WARNING, BRIGHT_YELLOW) << "The outputs and key images in a snapshot aren't verified, only load snapshots from a source you trust" << std::endl;
+    }
+
     RocksDBWrapper database(logManager);
     database.init(dbConfig);
     Tools::ScopeExit dbShutdownOnExit([&database] () { database.shutdown(); });
@@ -335,21 +386,59 @@ int main(int argc, char* argv[])
       dbShutdownOnExit.resume();
     }
 
-    System::Dispatcher dispatcher;
-    logger(INFO) << "Initializing core...";
+    /* Optionally commit the writes of several blocks at once. Declared after
+       the database, so pending writes are committed before it shuts down. */
+    std::unique_ptr<GroupCommitDataBase> groupCommitDatabase;
 
-    std::unique_ptr<IMainChainStorage> tmainChainStorage;
-    if ( config.useSqliteForLocalCaches )
+    if (config.dbGroupCommitBlocks > 1)
     {
-      tmainChainStorage = createSwappedMainChainStorageSqlite(config.dataDirectory, currency);
+      logger(INFO) << "Committing database writes every " << config.dbGroupCommitBlocks << " blocks";
+
+      groupCommitDatabase = std::make_unique<GroupCommitDataBase>(
+        database,
+        logManager,
+        static_cast<size_t>(config.dbGroupCommitBlocks),
+        CryptoNote::DATABASE_GROUP_COMMIT_MAX_SIZE,
+        std::chrono::milliseconds(CryptoNote::DATABASE_GROUP_COMMIT_MAX_AGE)
+      );
     }
-    else if ( config.useRocksdbForLocalCaches )
+
+    IDataBase& blockchainDatabase = groupCommitDatabase ? static_cast<IDataBase&>(*groupCommitDatabase) : database;
+
+    if (config.pruneDepth < 0 || (config.pruneDepth > 0 && static_cast<uint32_t>(config.pruneDepth) < CryptoNote::DATABASE_PRUNE_MIN_DEPTH))
     {
-      tmainChainStorage = createSwappedMainChainStorageRocksdb(config.dataDirectory, currency, dbConfig);
+      logger(ERROR, BRIGHT_RED) << "The prune depth must be 0, or at least " << CryptoNote::DATABASE_PRUNE_MIN_DEPTH << " blocks";
+      return 1;
     }
-    else
+
+    if (config.pruneDepth > 0)
     {
-      tmainChainStorage = createSwappedMainChainStorage(config.dataDirectory, currency);
+      logger(INFO) << "Pruning the transactions of blocks more than " << config.pruneDepth << " blocks deep";
+    }
+
+    System::Dispatcher dispatcher;
+    logger(INFO) << "Initializing core...";
+
+    Crypto::crypto_ops::setPointCacheSize(static_cast<size_t>(std::max(config.pointCacheSize, 0)));
+
+    /* Has to happen before the core starts any validation threads */
+    if (config.useRadix51Field)
+    {
+      if (!Crypto::crypto_ops::setFieldBackend(Crypto::FieldBackend::Radix51))
+      {
+        logger(ERROR, BRIGHT_RED) << "The radix 2^51 field arithmetic isn't available in this build";
+        return 1;
+      }
+
+      logger(WARNING, BRIGHT_YELLOW) << "Using the experimental radix 2^51 field arithmetic";
+    }
+
+    std::unique_ptr<IMainChainStorage> tmainChainStorage = createMainChainStorage();
+
+    if (config.pruneDepth > 0 && !tmainChainStorage->canPruneBlocks())
+    {
+      logger(ERROR, BRIGHT_RED) << "The local blockchain cache can only be pruned when using --sqlite or --rocksdb";
+      return 1;
     }
 
     CryptoNote::Core ccore(
@@ -357,8 +446,11 @@ int main(int argc, char* argv[])
       logManager,
       std::move(checkpoints),
       dispatcher,
-      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger())),
-      std::move(tmainChainStorage)
+      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(
+        blockchainDatabase, logger.getLogger(), static_cast<size_t>(std::max(config.dbKeyOutputCacheSize, 0)))),
+      std::move(tmainChainStorage),
+      static_cast<uint32_t>(std::max(config.validationThreads, 0)),
+      static_cast<uint32_t>(config.pruneDepth)
     );
 
     ccore.load();
@@ -366,10 +458,10 @@ int main(int argc, char* argv[])
 
     CryptoNote::CryptoNoteProtocolHandler cprotocol(currency, dispatcher, ccore, nullptr, logManager);
     CryptoNote::NodeServer p2psrv(dispatcher, cprotocol, logManager);
-    CryptoNote::RpcServer rpcServer(dispatcher, logManager, ccore, p2psrv, cprotocol);
+    CryptoNote::RpcServer rpcServer(dispatcher, logManager, ccore, p2psrv, cprotocol, blockchainDatabase);
 
     cprotocol.set_p2p_endpoint(&p2psrv);
-    DaemonCommandsHandler dch(ccore, p2psrv, logManager, &rpcServer);
+    DaemonCommandsHandler dch(ccore, p2psrv, logManager, &rpcServer, blockchainDatabase);
     logger(INFO) << "Initializing p2p server...";
     if (!p2psrv.init(netNodeConfig))
     {
@@ -10,6 +10,7 @@
 #include <CryptoNoteCore/Core.h>
 #include <CryptoNoteCore/CryptoNoteFormatUtils.h>
 #include <CryptoNoteCore/Currency.h>
+#include <CryptoNoteCore/Snapshot.h>
 
 #include <CryptoNoteProtocol/CryptoNoteProtocolHandler.h>
 
@@ -53,8 +54,8 @@ std::string printTransactionFullInfo(const CryptoNote::CachedTransaction& transa
 
 }
 
-DaemonCommandsHandler::DaemonCommandsHandler(CryptoNote::Core& core, CryptoNote::NodeServer& srv, std::shared_ptr<Logging::LoggerManager> log, CryptoNote::RpcServer* prpc_server) :
-  m_core(core), m_srv(srv), logger(log, "daemon"), m_logManager(log), m_prpc_server(prpc_server) {
+DaemonCommandsHandler::DaemonCommandsHandler(CryptoNote::Core& core, CryptoNote::NodeServer& srv, std::shared_ptr<Logging::LoggerManager> log, CryptoNote::RpcServer* prpc_server, CryptoNote::IDataBase& database) :
+  m_core(core), m_srv(srv), logger(log, "daemon"), m_logManager(log), m_prpc_server(prpc_server), m_database(database) {
   m_consoleHandler.setHandler("exit", boost::bind(&DaemonCommandsHandler::exit, this, _1), "Shutdown the daemon");
   m_consoleHandler.setHandler("help", boost::bind(&DaemonCommandsHandler::help, this, _1), "Show this help");
   m_consoleHandler.setHandler("print_pl", boost::bind(&DaemonCommandsHandler::print_pl, this, _1), "Print peer list");
@@ -66,6 +67,8 @@ DaemonCommandsHandler::DaemonCommandsHandler(CryptoNote::Core& core, CryptoNote:
   m_consoleHandler.setHandler("print_pool_sh", boost::bind(&DaemonCommandsHandler::print_pool_sh, this, _1), "Print transaction pool (short format)");
   m_consoleHandler.setHandler("set_log", boost::bind(&DaemonCommandsHandler::set_log, this, _1), "set_log <level> - Change current log level, <level> is a number 0-4");
   m_consoleHandler.setHandler("status", boost::bind(&DaemonCommandsHandler::status, this, _1), "Show daemon status");
+  m_consoleHandler.setHandler("export_snapshot", boost::bind(&DaemonCommandsHandler::export_snapshot, this, _1), "Write a snapshot of the blockchain data for --load-snapshot, export_snapshot <directory>");
+  m_consoleHandler.setHandler("db_stats", boost::bind(&DaemonCommandsHandler::db_stats, this, _1), "Show database statistics");
 }
 
 //--------------------------------------------------------------------------------
@@ -324,3 +327,39 @@ bool DaemonCommandsHandler::status(const std::vector<std::string>& args)
   
   return true;
 }
+//--------------------------------------------------------------------------------
+bool DaemonCommandsHandler::export_snapshot(const std::vector<std::string>& args)
+{
+  if (args.size() != 1) {
+    std::cout << "use: export_snapshot <directory>" << std::endl;
+    return true;
+  }
+
+  std::cout << "Exporting snapshot to " << args[0] << ", this may take a while..." << std::endl;
+
+  try {
+    const CryptoNote::SnapshotManifest manifest = CryptoNote::exportSnapshot(args[0], m_core, m_database);
+
+    std::cout << "Exported snapshot of " << manifest.blockCount << " blocks, top block " << manifest.topHash << std::endl;
+  } catch (const std::exception& e) {
+    std::cout << "Failed to export snapshot: " << e.what() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+//--------------------------------------------------------------------------------
+bool DaemonCommandsHandler::db_stats(const std::vector<std::string>& args)
+{
+  CryptoNote::COMMAND_RPC_GET_DB_STATS::request req;
+  CryptoNote::COMMAND_RPC_GET_DB_STATS::response resp;
+
+  if (!m_prpc_server->on_get_db_stats(req, resp) || resp.status != CORE_RPC_STATUS_OK) {
+    std::cout << "Problem retrieving information from RPC server." << std::endl;
+    return false;
+  }
+
+  std::cout << Utilities::get_db_stats_string(resp) << std::endl;
+
+  return true;
+}
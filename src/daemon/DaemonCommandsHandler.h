@@ -15,13 +15,14 @@
 
 namespace CryptoNote {
 class Core;
+class IDataBase;
 class NodeServer;
 }
 
 class DaemonCommandsHandler
 {
 public:
-  DaemonCommandsHandler(CryptoNote::Core& core, CryptoNote::NodeServer& srv, std::shared_ptr<Logging::LoggerManager> log, CryptoNote::RpcServer* prpc_server);
+  DaemonCommandsHandler(CryptoNote::Core& core, CryptoNote::NodeServer& srv, std::shared_ptr<Logging::LoggerManager> log, CryptoNote::RpcServer* prpc_server, CryptoNote::IDataBase& database);
 
   bool start_handling() {
     m_consoleHandler.start();
@@ -42,6 +43,7 @@ private:
   Logging::LoggerRef logger;
   std::shared_ptr<Logging::LoggerManager> m_logManager;
   CryptoNote::RpcServer* m_prpc_server;
+  CryptoNote::IDataBase& m_database;
 
   std::string get_commands_str();
   bool print_block_by_height(uint32_t height);
@@ -63,4 +65,6 @@ private:
   bool start_mining(const std::vector<std::string>& args);
   bool stop_mining(const std::vector<std::string>& args);
   bool status(const std::vector<std::string>& args);
+  bool export_snapshot(const std::vector<std::string>& args);
+  bool db_stats(const std::vector<std::string>& args);
 };
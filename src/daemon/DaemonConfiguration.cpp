@@ -37,7 +37,9 @@ namespace DaemonConfig{
 
     options.add_options("Core")
       ("help", "Display this help message", cxxopts::value<bool>()->implicit_value("true"))
+      ("load-snapshot", "Replaces the blockchain data with the snapshot in <path>, written by the export_snapshot command", cxxopts::value<std::string>(config.loadSnapshot), "<path>")
       ("os-version", "Output Operating System version information", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("migrate-raw-blocks", "Rewrites blocks stored in the local cache by older versions in the binary block format", cxxopts::value<bool>(config.migrateRawBlocks)->default_value("false")->implicit_value("true"))
       ("resync", "Forces the daemon to delete the blockchain data and start resyncing", cxxopts::value<bool>(config.resync)->default_value("false")->implicit_value("true"))
       ("rewind-to-height", "Rewinds the local blockchain cache to the specified height.", cxxopts::value<uint32_t>(), "#")
       ("version","Output daemon version information",cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
@@ -54,10 +56,15 @@ namespace DaemonConfig{
         cxxopts::value<std::string>()->default_value(config.checkPoints), "<path>")
       ("log-file", "Specify the <path> to the log file", cxxopts::value<std::string>()->default_value(config.logFile), "<path>")
       ("log-level", "Specify log level", cxxopts::value<int>()->default_value(std::to_string(config.logLevel)), "#")
+      ("mmap", "Use memory mapped files for local cache files", cxxopts::value<bool>(config.useMmapForLocalCaches)->default_value("false")->implicit_value("true"))
       ("no-console", "Disable daemon console commands", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("point-cache-size", "Number of decompressed ring members kept in memory for ring signature checks (0 = off)", cxxopts::value<int>()->default_value(std::to_string(config.pointCacheSize)), "#")
+      ("radix51-field", "Experimental: use the radix 2^51 field arithmetic for the elliptic curve operations instead of ref10, where this build supports it",
+        cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
       ("rocksdb", "Use Rocksdb for local cache files", cxxopts::value<bool>(config.useRocksdbForLocalCaches)->default_value("false")->implicit_value("true"))
       ("save-config", "Save the configuration to the specified <file>", cxxopts::value<std::string>(), "<file>")
-      ("sqlite", "Use SQLite3 for local cache files", cxxopts::value<bool>(config.useSqliteForLocalCaches)->default_value("false")->implicit_value("true"));
+      ("sqlite", "Use SQLite3 for local cache files", cxxopts::value<bool>(config.useSqliteForLocalCaches)->default_value("false")->implicit_value("true"))
+      ("validation-threads", "Number of threads used to verify block ring signatures (0 = one per CPU core)", cxxopts::value<int>()->default_value(std::to_string(config.validationThreads)), "#");
 
     options.add_options("RPC")
       ("enable-blockexplorer", "Enable the Blockchain Explorer RPC", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
@@ -83,11 +90,16 @@ namespace DaemonConfig{
       ("seed-node", "Connect to a node to retrieve the peer list and then disconnect", cxxopts::value<std::vector<std::string>>(), "<ip:port>");
 
     options.add_options("Database")
+      ("db-column-family", "Tune one column family of the database, as <name>:<setting>=<value>,... where a setting is one of block-size, bloom-bits, prefix-length, compression (0 or 1) or cache-share (percent of the read cache). Can be given more than once.",
+        cxxopts::value<std::vector<std::string>>(), "<tuning>")
       ("db-enable-compression", "Enable database compression", cxxopts::value<bool>(config.enableDbCompression)->default_value("false")->implicit_value("true"))
+      ("db-group-commit-blocks", "Number of consecutive blocks whose database writes are committed together, at any time and not only while syncing. Writes more than " + std::to_string(CryptoNote::DATABASE_GROUP_COMMIT_MAX_AGE / 1000) + " seconds old are committed with the next block. (0 = commit every block on its own)", cxxopts::value<int>()->default_value(std::to_string(config.dbGroupCommitBlocks)), "#")
+      ("db-key-output-cache-size", "Number of ring member outputs kept in memory for transaction validation", cxxopts::value<int>()->default_value(std::to_string(config.dbKeyOutputCacheSize)), "#")
       ("db-max-open-files", "Number of files that can be used by the database at one time", cxxopts::value<int>()->default_value(std::to_string(config.dbMaxOpenFiles)), "#")
       ("db-read-buffer-size", "Size of the database read cache in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbReadCacheSizeMB)), "#")
       ("db-threads", "Number of background threads used for compaction and flush operations", cxxopts::value<int>()->default_value(std::to_string(config.dbThreads)), "#")
-      ("db-write-buffer-size", "Size of the database write buffer in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbWriteBufferSizeMB)), "#");
+      ("db-write-buffer-size", "Size of the database write buffer in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbWriteBufferSizeMB)), "#")
+      ("prune-depth", "Drop the transactions of blocks more than this many blocks below the top, and tell peers not to ask for them (0 = keep every block whole)", cxxopts::value<int>()->default_value(std::to_string(config.pruneDepth)), "#");
 
     try
     {
@@ -178,6 +190,31 @@ namespace DaemonConfig{
         config.useRocksdbForLocalCaches = cli["rocksdb"].as<bool>();
       }
 
+      if (cli.count("mmap") > 0)
+      {
+        config.useMmapForLocalCaches = cli["mmap"].as<bool>();
+      }
+
+      if (cli.count("validation-threads") > 0)
+      {
+        config.validationThreads = cli["validation-threads"].as<int>();
+      }
+
+      if (cli.count("point-cache-size") > 0)
+      {
+        config.pointCacheSize = cli["point-cache-size"].as<int>();
+      }
+
+      if (cli.count("radix51-field") > 0)
+      {
+        config.useRadix51Field = cli["radix51-field"].as<bool>();
+      }
+
+      if (cli.count("db-column-family") > 0)
+      {
+        config.dbColumnFamilies = cli["db-column-family"].as<std::vector<std::string>>();
+      }
+
       if (cli.count("db-enable-compression") > 0)
       {
         config.enableDbCompression = cli["db-enable-compression"].as<bool>();
@@ -193,6 +230,21 @@ namespace DaemonConfig{
         config.dbMaxOpenFiles = cli["db-max-open-files"].as<int>();
       }
 
+      if (cli.count("db-group-commit-blocks") > 0)
+      {
+        config.dbGroupCommitBlocks = cli["db-group-commit-blocks"].as<int>();
+      }
+
+      if (cli.count("prune-depth") > 0)
+      {
+        config.pruneDepth = cli["prune-depth"].as<int>();
+      }
+
+      if (cli.count("db-key-output-cache-size") > 0)
+      {
+        config.dbKeyOutputCacheSize = cli["db-key-output-cache-size"].as<int>();
+      }
+
       if (cli.count("db-read-buffer-size") > 0)
       {
         config.dbReadCacheSizeMB = cli["db-read-buffer-size"].as<int>();
@@ -331,6 +383,7 @@ namespace DaemonConfig{
     std::vector<std::string> seedNodes;
     std::vector<std::string> peers;
     std::vector<std::string> cors;
+    std::vector<std::string> columnFamilies;
     bool updated = false;
 
     for (std::string line; std::getline(data, line);)
@@ -387,6 +440,40 @@ namespace DaemonConfig{
           config.useRocksdbForLocalCaches = cfgValue.at(0) == '1';
           updated = true;
         }
+        else if (cfgKey.compare("mmap") == 0)
+        {
+          config.useMmapForLocalCaches = cfgValue.at(0) == '1';
+          updated = true;
+        }
+        else if (cfgKey.compare("validation-threads") == 0)
+        {
+          try
+          {
+            config.validationThreads = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
+        else if (cfgKey.compare("point-cache-size") == 0)
+        {
+          try
+          {
+            config.pointCacheSize = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
+        else if (cfgKey.compare("radix51-field") == 0)
+        {
+          config.useRadix51Field = cfgValue.at(0) == '1';
+          updated = true;
+        }
         else if (cfgKey.compare("db-enable-compression") == 0)
         {
           config.enableDbCompression = cfgValue.at(0) == '1';
@@ -409,6 +496,48 @@ namespace DaemonConfig{
             throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
           }
         }
+        else if (cfgKey.compare("db-group-commit-blocks") == 0)
+        {
+          try
+          {
+            config.dbGroupCommitBlocks = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
+        else if (cfgKey.compare("prune-depth") == 0)
+        {
+          try
+          {
+            config.pruneDepth = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
+        else if (cfgKey.compare("db-column-family") == 0)
+        {
+          columnFamilies.push_back(cfgValue);
+          config.dbColumnFamilies = columnFamilies;
+          updated = true;
+        }
+        else if (cfgKey.compare("db-key-output-cache-size") == 0)
+        {
+          try
+          {
+            config.dbKeyOutputCacheSize = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
         else if (cfgKey.compare("db-read-buffer-size") == 0)
         {
           try
@@ -635,6 +764,26 @@ namespace DaemonConfig{
       config.useRocksdbForLocalCaches = j["rocksdb"].GetBool();
     }
 
+    if (j.HasMember("mmap"))
+    {
+      config.useMmapForLocalCaches = j["mmap"].GetBool();
+    }
+
+    if (j.HasMember("validation-threads"))
+    {
+      config.validationThreads = j["validation-threads"].GetInt();
+    }
+
+    if (j.HasMember("point-cache-size"))
+    {
+      config.pointCacheSize = j["point-cache-size"].GetInt();
+    }
+
+    if (j.HasMember("radix51-field"))
+    {
+      config.useRadix51Field = j["radix51-field"].GetBool();
+    }
+
     if (j.HasMember("db-enable-compression"))
     {
       config.enableDbCompression = j["db-enable-compression"].GetBool();
@@ -650,6 +799,30 @@ namespace DaemonConfig{
       config.dbMaxOpenFiles = j["db-max-open-files"].GetInt();
     }
 
+    if (j.HasMember("db-group-commit-blocks"))
+    {
+      config.dbGroupCommitBlocks = j["db-group-commit-blocks"].GetInt();
+    }
+
+    if (j.HasMember("prune-depth"))
+    {
+      config.pruneDepth = j["prune-depth"].GetInt();
+    }
+
+    if (j.HasMember("db-column-family"))
+    {
+      const Value& va = j["db-column-family"];
+      for (auto& v : va.GetArray())
+      {
+          config.dbColumnFamilies.push_back(v.GetString());
+      }
+    }
+
+    if (j.HasMember("db-key-output-cache-size"))
+    {
+      config.dbKeyOutputCacheSize = j["db-key-output-cache-size"].GetInt();
+    }
+
     if (j.HasMember("db-read-buffer-size"))
     {
       config.dbReadCacheSizeMB = j["db-read-buffer-size"].GetInt();
@@ -776,14 +949,31 @@ namespace DaemonConfig{
     j.AddMember("load-checkpoints", config.checkPoints, alloc);
     j.AddMember("log-file", config.logFile, alloc);
     j.AddMember("log-level", config.logLevel, alloc);
+    j.AddMember("mmap", config.useMmapForLocalCaches, alloc);
     j.AddMember("no-console", config.noConsole, alloc);
     j.AddMember("rocksdb", config.useRocksdbForLocalCaches, alloc);
     j.AddMember("sqlite", config.useSqliteForLocalCaches, alloc);
+    j.AddMember("validation-threads", config.validationThreads, alloc);
+    j.AddMember("point-cache-size", config.pointCacheSize, alloc);
+    j.AddMember("radix51-field", config.useRadix51Field, alloc);
     j.AddMember("db-enable-compression", config.enableDbCompression, alloc);
     j.AddMember("db-max-open-files", config.dbMaxOpenFiles, alloc);
     j.AddMember("db-read-buffer-size", (config.dbReadCacheSizeMB), alloc);
+    j.AddMember("db-group-commit-blocks", config.dbGroupCommitBlocks, alloc);
+    j.AddMember("db-key-output-cache-size", config.dbKeyOutputCacheSize, alloc);
+
+    {
+        Value arr(rapidjson::kArrayType);
+        for(auto v : config.dbColumnFamilies)
+        {
+            arr.PushBack(Value().SetString(StringRef(v.c_str())), alloc);
+        }
+        j.AddMember("db-column-family", arr, alloc);
+    }
+
     j.AddMember("db-threads", config.dbThreads, alloc);
     j.AddMember("db-write-buffer-size", (config.dbWriteBufferSizeMB), alloc);
+    j.AddMember("prune-depth", config.pruneDepth, alloc);
     j.AddMember("allow-local-ip", config.localIp, alloc);
     j.AddMember("hide-my-port", config.hideMyPort, alloc);
     j.AddMember("p2p-bind-ip", config.p2pInterface, alloc);
@@ -29,6 +29,11 @@ namespace DaemonConfig {
       dbReadCacheSizeMB = CryptoNote::DATABASE_READ_BUFFER_MB_DEFAULT_SIZE;
       dbThreads = CryptoNote::DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT;
       dbWriteBufferSizeMB = CryptoNote::DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE;
+      dbKeyOutputCacheSize = CryptoNote::KEY_OUTPUT_CACHE_DEFAULT_SIZE;
+      dbGroupCommitBlocks = CryptoNote::DATABASE_GROUP_COMMIT_DEFAULT_BLOCKS;
+      pruneDepth = CryptoNote::DATABASE_PRUNE_DEFAULT_DEPTH;
+      validationThreads = CryptoNote::VALIDATION_DEFAULT_THREADS_COUNT;
+      pointCacheSize = CryptoNote::VALIDATION_POINT_CACHE_DEFAULT_SIZE;
       rewindToHeight = 0;
       p2pInterface = "0.0.0.0";
       p2pPort = CryptoNote::P2P_DEFAULT_PORT;
@@ -37,6 +42,7 @@ namespace DaemonConfig {
       rpcPort = CryptoNote::RPC_DEFAULT_PORT;
       noConsole = false;
       enableBlockExplorer = false;
+      useRadix51Field = false;
       localIp = false;
       hideMyPort = false;
       p2pResetPeerstate = false;
@@ -47,8 +53,10 @@ namespace DaemonConfig {
       dumpConfig = false;
       useSqliteForLocalCaches = false;
       useRocksdbForLocalCaches = false;
+      useMmapForLocalCaches = false;
       enableDbCompression = false;
       resync = false;
+      migrateRawBlocks = false;
     }
 
     std::string dataDirectory;
@@ -73,18 +81,27 @@ namespace DaemonConfig {
     int dbMaxOpenFiles;
     int dbWriteBufferSizeMB;
     int dbReadCacheSizeMB;
+    int dbKeyOutputCacheSize;
+    int dbGroupCommitBlocks;
+    std::vector<std::string> dbColumnFamilies;
+    int pruneDepth;
+    int validationThreads;
+    int pointCacheSize;
 
     uint32_t rewindToHeight;
 
     bool noConsole;
     bool enableBlockExplorer;
+    bool useRadix51Field;
     bool localIp;
     bool hideMyPort;
     bool resync;
+    bool migrateRawBlocks;
     bool p2pResetPeerstate;
 
     std::string configFile;
     std::string outputFile;
+    std::string loadSnapshot;
     std::vector<std::string> genesisAwardAddresses;
     bool help;
     bool version;
@@ -93,6 +110,7 @@ namespace DaemonConfig {
     bool dumpConfig;
     bool useSqliteForLocalCaches;
     bool useRocksdbForLocalCaches;
+    bool useMmapForLocalCaches;
     bool enableDbCompression;
   };
 
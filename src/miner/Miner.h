@@ -16,6 +16,8 @@
 
 #include "CryptoNote.h"
 
+#include "crypto/hash.h"
+
 namespace CryptoNote {
 
 struct BlockMiningParameters
@@ -32,6 +34,10 @@ class Miner
         BlockTemplate mine(const BlockMiningParameters& blockMiningParameters, size_t threadCount);
         uint64_t getHashCount();
 
+        /* How the workers' slow hash scratchpads were allocated, the worst
+           of them if they differ */
+        int getScratchpadMode();
+
         //NOTE! this is blocking method
         void stop();
 
@@ -46,12 +52,14 @@ class Miner
 
         BlockTemplate m_block;
         std::atomic<uint64_t> m_hash_count = 0;
+        std::atomic<int> m_scratchpadMode = Crypto::SLOW_HASH_SCRATCHPAD_NONE;
         std::mutex m_hashes_mutex;
 
         void runWorkers(BlockMiningParameters blockMiningParameters, size_t threadCount);
         void workerFunc(const BlockTemplate& blockTemplate, uint64_t difficulty, uint32_t nonceStep);
         bool setStateBlockFound();
         void incrementHashCount();
+        void updateScratchpadMode();
 };
 
 } //namespace CryptoNote
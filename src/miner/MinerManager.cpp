@@ -114,6 +114,8 @@ void MinerManager::printHashRate()
 
         std::cout << SuccessMsg("\nMining at ")
                   << SuccessMsg(Utilities::get_mining_speed(hashes))
+                  << SuccessMsg(", scratchpads in ")
+                  << SuccessMsg(Crypto::slow_hash_scratchpad_mode_name(m_miner.getScratchpadMode()))
                   << "\n\n";
     }
 }
@@ -65,10 +65,14 @@ namespace CryptoNote
   {
     uint32_t current_height;
     Crypto::Hash top_id;
+    /* Blocks below this height are pruned, and won't be served. Not sent by
+       older nodes, which keep every block. */
+    uint32_t pruned_height = 0;
 
     void serialize(ISerializer& s) {
       KV_MEMBER(current_height)
       KV_MEMBER(top_id)
+      KV_MEMBER(pruned_height)
     }
   };
 
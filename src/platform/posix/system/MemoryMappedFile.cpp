@@ -249,6 +249,16 @@ void MemoryMappedFile::flush(uint8_t* data, uint64_t size) {
   }
 }
 
+void MemoryMappedFile::prefetch(const uint8_t* data, uint64_t size) const {
+  assert(isOpened());
+
+  uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  uintptr_t dataAddr = reinterpret_cast<uintptr_t>(data);
+  uintptr_t pageOffset = (dataAddr / pageSize) * pageSize;
+
+  ::madvise(reinterpret_cast<void*>(pageOffset), static_cast<size_t>(dataAddr % pageSize + size), MADV_WILLNEED);
+}
+
 void MemoryMappedFile::swap(MemoryMappedFile& other) {
   std::swap(m_file, other.m_file);
   std::swap(m_path, other.m_path);
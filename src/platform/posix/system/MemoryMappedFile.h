@@ -47,6 +47,11 @@ public:
   void flush(uint8_t* data, uint64_t size, std::error_code& ec);
   void flush(uint8_t* data, uint64_t size);
 
+  /* Hints that [data, data + size) will be read soon, so it can be read
+     ahead of being touched. Failing to do so is harmless, so errors are
+     ignored. */
+  void prefetch(const uint8_t* data, uint64_t size) const;
+
   void swap(MemoryMappedFile& other);
 
 private:
@@ -282,6 +282,13 @@ void MemoryMappedFile::flush(uint8_t* data, uint64_t size) {
   }
 }
 
+void MemoryMappedFile::prefetch(const uint8_t* data, uint64_t size) const {
+  assert(isOpened());
+
+  /* PrefetchVirtualMemory() needs Windows 8, so we leave this to the
+     system's own read ahead */
+}
+
 void MemoryMappedFile::swap(MemoryMappedFile& other) {
   std::swap(m_fileHandle, other.m_fileHandle);
   std::swap(m_mappingHandle, other.m_mappingHandle);
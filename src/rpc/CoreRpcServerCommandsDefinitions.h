@@ -335,6 +335,12 @@ struct COMMAND_RPC_GET_INFO {
     uint8_t minor_version;
     std::string version;
     uint64_t start_time;
+    uint64_t signature_cache_hits;
+    uint64_t signature_cache_misses;
+    uint64_t key_output_cache_hits;
+    uint64_t key_output_cache_misses;
+    uint64_t point_cache_hits;
+    uint64_t point_cache_misses;
     bool synced;
     bool testnet;
 
@@ -357,6 +363,12 @@ struct COMMAND_RPC_GET_INFO {
       KV_MEMBER(major_version)
       KV_MEMBER(minor_version)
       KV_MEMBER(start_time)
+      KV_MEMBER(signature_cache_hits)
+      KV_MEMBER(signature_cache_misses)
+      KV_MEMBER(key_output_cache_hits)
+      KV_MEMBER(key_output_cache_misses)
+      KV_MEMBER(point_cache_hits)
+      KV_MEMBER(point_cache_misses)
       KV_MEMBER(synced)
       KV_MEMBER(testnet)
       KV_MEMBER(version)
@@ -364,6 +376,89 @@ struct COMMAND_RPC_GET_INFO {
   };
 };
 
+//-----------------------------------------------
+struct db_latency {
+  uint64_t count;
+  double median;
+  double percentile95;
+  double percentile99;
+  double max;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(count)
+    KV_MEMBER(median)
+    KV_MEMBER(percentile95)
+    KV_MEMBER(percentile99)
+    KV_MEMBER(max)
+  }
+};
+
+struct db_column_family_stats {
+  std::string name;
+  uint64_t keys_read;
+  uint64_t keys_found;
+  uint64_t bytes_read;
+  uint64_t keys_written;
+  uint64_t keys_removed;
+  uint64_t bytes_written;
+  uint64_t memtable_bytes;
+  uint64_t level0_files;
+  uint64_t table_bytes;
+  uint64_t estimated_keys;
+  uint64_t block_cache_bytes;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(name)
+    KV_MEMBER(keys_read)
+    KV_MEMBER(keys_found)
+    KV_MEMBER(bytes_read)
+    KV_MEMBER(keys_written)
+    KV_MEMBER(keys_removed)
+    KV_MEMBER(bytes_written)
+    KV_MEMBER(memtable_bytes)
+    KV_MEMBER(level0_files)
+    KV_MEMBER(table_bytes)
+    KV_MEMBER(estimated_keys)
+    KV_MEMBER(block_cache_bytes)
+  }
+};
+
+struct COMMAND_RPC_GET_DB_STATS {
+  typedef EMPTY_STRUCT request;
+
+  struct response {
+    std::string status;
+    uint64_t read_batches;
+    uint64_t write_batches;
+    uint64_t block_cache_hits;
+    uint64_t block_cache_misses;
+    uint64_t stall_micros;
+    bool writes_stopped;
+    uint64_t running_compactions;
+    uint64_t compaction_bytes_read;
+    uint64_t compaction_bytes_written;
+    db_latency read_latency;
+    db_latency write_latency;
+    std::vector<db_column_family_stats> column_families;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(read_batches)
+      KV_MEMBER(write_batches)
+      KV_MEMBER(block_cache_hits)
+      KV_MEMBER(block_cache_misses)
+      KV_MEMBER(stall_micros)
+      KV_MEMBER(writes_stopped)
+      KV_MEMBER(running_compactions)
+      KV_MEMBER(compaction_bytes_read)
+      KV_MEMBER(compaction_bytes_written)
+      KV_MEMBER(read_latency)
+      KV_MEMBER(write_latency)
+      KV_MEMBER(column_families)
+    }
+  };
+};
+
 //-----------------------------------------------
 struct COMMAND_RPC_STOP_MINING {
   typedef EMPTY_STRUCT request;
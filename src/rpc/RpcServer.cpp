@@ -17,6 +17,10 @@
 #include <CryptoNoteCore/Core.h>
 #include <CryptoNoteCore/CryptoNoteFormatUtils.h>
 
+#include <crypto/crypto.h>
+
+#include <IDataBase.h>
+
 #include <Common/CryptoNoteTools.h>
 #include <Common/TransactionExtra.h>
 
@@ -67,39 +71,6 @@ void serialize(BlockShortInfo& blockShortInfo, ISerializer& s) {
   KV_MEMBER(blockShortInfo.txPrefixes);
 }
 
-void serialize(WalletTypes::WalletBlockInfo &walletBlockInfo, ISerializer &s)
-{
-    s(walletBlockInfo.coinbaseTransaction, "coinbaseTX");
-    s(walletBlockInfo.transactions, "transactions");
-    s(walletBlockInfo.blockHeight, "blockHeight");
-    s(walletBlockInfo.blockHash, "blockHash");
-    s(walletBlockInfo.blockTimestamp, "blockTimestamp");
-}
-
-void serialize(WalletTypes::RawTransaction &rawTransaction, ISerializer &s)
-{
-    s(rawTransaction.keyInputs, "inputs");
-    s(rawTransaction.paymentID, "paymentID");
-    s(rawTransaction.keyOutputs, "outputs");
-    s(rawTransaction.hash, "hash");
-    s(rawTransaction.transactionPublicKey, "txPublicKey");
-    s(rawTransaction.unlockTime, "unlockTime");
-}
-
-void serialize(WalletTypes::RawCoinbaseTransaction &rawCoinbaseTransaction, ISerializer &s)
-{
-    s(rawCoinbaseTransaction.keyOutputs, "outputs");
-    s(rawCoinbaseTransaction.hash, "hash");
-    s(rawCoinbaseTransaction.transactionPublicKey, "txPublicKey");
-    s(rawCoinbaseTransaction.unlockTime, "unlockTime");
-}
-
-void serialize(WalletTypes::KeyOutput &keyOutput, ISerializer &s)
-{
-    s(keyOutput.key, "key");
-    s(keyOutput.amount, "amount");
-}
-
 namespace {
 
 template <typename Command>
@@ -138,6 +109,7 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/height", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true } },
   { "/fee", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_info), true } },
   { "/peers", { jsonMethod<COMMAND_RPC_GET_PEERS>(&RpcServer::on_get_peers), true } },
+  { "/dbstats", { jsonMethod<COMMAND_RPC_GET_DB_STATS>(&RpcServer::on_get_db_stats), true } },
 
   { "/gettransactions", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false } },
   { "/sendrawtransaction", { jsonMethod<COMMAND_RPC_SEND_RAW_TX>(&RpcServer::on_send_raw_tx), false } },
@@ -164,8 +136,8 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
 };
 
-RpcServer::RpcServer(System::Dispatcher& dispatcher, std::shared_ptr<Logging::ILogger> log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol) :
-  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol) {
+RpcServer::RpcServer(System::Dispatcher& dispatcher, std::shared_ptr<Logging::ILogger> log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol, IDataBase& database) :
+  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol), m_database(database) {
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -604,6 +576,60 @@ bool RpcServer::on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RP
   res.version = PROJECT_VERSION;
   res.status = CORE_RPC_STATUS_OK;
   res.start_time = (uint64_t)m_core.getStartTime();
+  res.signature_cache_hits = m_core.getSignatureCacheHits();
+  res.signature_cache_misses = m_core.getSignatureCacheMisses();
+  res.key_output_cache_hits = m_core.getKeyOutputCacheHits();
+  res.key_output_cache_misses = m_core.getKeyOutputCacheMisses();
+
+  const Crypto::PointCacheStatistics pointCacheStatistics = Crypto::crypto_ops::getPointCacheStatistics();
+  res.point_cache_hits = pointCacheStatistics.hits;
+  res.point_cache_misses = pointCacheStatistics.misses;
+  return true;
+}
+
+bool RpcServer::on_get_db_stats(const COMMAND_RPC_GET_DB_STATS::request& req, COMMAND_RPC_GET_DB_STATS::response& res) {
+  const DataBaseStatistics stats = m_database.getStatistics();
+
+  const auto toLatency = [](const DataBaseLatency& latency) {
+    db_latency result;
+    result.count = latency.count;
+    result.median = latency.median;
+    result.percentile95 = latency.percentile95;
+    result.percentile99 = latency.percentile99;
+    result.max = latency.max;
+    return result;
+  };
+
+  res.read_batches = stats.readBatches;
+  res.write_batches = stats.writeBatches;
+  res.block_cache_hits = stats.blockCacheHits;
+  res.block_cache_misses = stats.blockCacheMisses;
+  res.stall_micros = stats.stallMicros;
+  res.writes_stopped = stats.writesStopped;
+  res.running_compactions = stats.runningCompactions;
+  res.compaction_bytes_read = stats.compactionBytesRead;
+  res.compaction_bytes_written = stats.compactionBytesWritten;
+  res.read_latency = toLatency(stats.readLatency);
+  res.write_latency = toLatency(stats.writeLatency);
+
+  for (const auto& family : stats.families) {
+    db_column_family_stats familyStats;
+    familyStats.name = family.name;
+    familyStats.keys_read = family.keysRead;
+    familyStats.keys_found = family.keysFound;
+    familyStats.bytes_read = family.bytesRead;
+    familyStats.keys_written = family.keysWritten;
+    familyStats.keys_removed = family.keysRemoved;
+    familyStats.bytes_written = family.bytesWritten;
+    familyStats.memtable_bytes = family.memtableBytes;
+    familyStats.level0_files = family.level0Files;
+    familyStats.table_bytes = family.tableBytes;
+    familyStats.estimated_keys = family.estimatedKeys;
+    familyStats.block_cache_bytes = family.blockCacheBytes;
+    res.column_families.push_back(familyStats);
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
   return true;
 }
 
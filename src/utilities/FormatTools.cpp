@@ -245,6 +245,53 @@ std::string get_status_string(CryptoNote::COMMAND_RPC_GET_INFO::response iresp)
   return ss.str();
 }
 
+std::string get_db_stats_string(CryptoNote::COMMAND_RPC_GET_DB_STATS::response resp) {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(2);
+
+  const uint64_t cacheLookups = resp.block_cache_hits + resp.block_cache_misses;
+
+  ss << "Batches: " << resp.read_batches << " read, " << resp.write_batches << " written" << std::endl
+     << "Block cache: " << resp.block_cache_hits << " hits, " << resp.block_cache_misses << " misses";
+
+  if (cacheLookups != 0) {
+    ss << " (" << 100.0 * resp.block_cache_hits / cacheLookups << "% hit rate)";
+  }
+
+  ss << std::endl;
+
+  const auto printLatency = [&ss](const std::string& name, const CryptoNote::db_latency& latency) {
+    ss << name << " latency: " << latency.count << " calls, median " << latency.median << "us, p95 "
+       << latency.percentile95 << "us, p99 " << latency.percentile99 << "us, max " << latency.max << "us" << std::endl;
+  };
+
+  printLatency("Read", resp.read_latency);
+  printLatency("Write", resp.write_latency);
+
+  ss << "Write stalls: " << resp.stall_micros / 1000 << "ms" << (resp.writes_stopped ? ", writes stopped" : "")
+     << ", " << resp.running_compactions << " compactions running, compactions read "
+     << prettyPrintBytes(resp.compaction_bytes_read) << " and wrote " << prettyPrintBytes(resp.compaction_bytes_written)
+     << std::endl << std::endl;
+
+  ss << std::left << std::setw(34) << "Column family" << std::right
+     << std::setw(12) << "Keys read" << std::setw(12) << "Found" << std::setw(12) << "Read"
+     << std::setw(12) << "Written" << std::setw(12) << "Removed" << std::setw(12) << "Written"
+     << std::setw(12) << "Memtables" << std::setw(5) << "L0" << std::setw(12) << "Tables"
+     << std::setw(12) << "Cached" << std::endl;
+
+  for (const auto& family : resp.column_families) {
+    ss << std::left << std::setw(34) << family.name << std::right
+       << std::setw(12) << family.keys_read << std::setw(12) << family.keys_found
+       << std::setw(12) << prettyPrintBytes(family.bytes_read) << std::setw(12) << family.keys_written
+       << std::setw(12) << family.keys_removed << std::setw(12) << prettyPrintBytes(family.bytes_written)
+       << std::setw(12) << prettyPrintBytes(family.memtable_bytes) << std::setw(5) << family.level0_files
+       << std::setw(12) << prettyPrintBytes(family.table_bytes) << std::setw(12) << prettyPrintBytes(family.block_cache_bytes)
+       << std::endl;
+  }
+
+  return ss.str();
+}
+
 /* Get the amount we need to divide to convert from atomic to pretty print,
    e.g. 100 for 2 decimal places */
 uint64_t getDivisor()
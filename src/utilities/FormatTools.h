@@ -23,6 +23,8 @@ namespace Utilities
 
     std::string get_status_string(CryptoNote::COMMAND_RPC_GET_INFO::response iresp);
 
+    std::string get_db_stats_string(CryptoNote::COMMAND_RPC_GET_DB_STATS::response resp);
+
     std::string formatAmount(const uint64_t amount);
 
     std::string formatAmountBasic(const uint64_t amount);